@@ -6,13 +6,63 @@
 #include <XoshiroCpp.hpp>
 
 #include "lattice.hpp"
+#include "observables/sink.hpp"
 #include "observables/type.hpp"
 
 namespace algorithms {
-    enum Algorithm { METROPOLIS = 0, WOLFF = 1 };
+    enum Algorithm { METROPOLIS = 0, WOLFF = 1, HEAT_BATH = 2, SWENDSEN_WANG = 3 };
 
     std::ostream& operator<<(std::ostream& out, Algorithm value);
 
+    /**
+     * The order in which a Metropolis sweep visits the lattice sites. The checkerboard order first updates all sites
+     * with an even row + col parity and then all sites with an odd one, which allows updating four sites at once.
+     */
+    enum Sweep { SEQUENTIAL = 0, CHECKERBOARD = 1 };
+
+    /**
+     * The floating point type in which the spins are stored and updated. The observables are always accumulated in
+     * double precision, so single precision only affects the lattice itself and the SIMD kernels operating on it.
+     */
+    enum Precision { DOUBLE = 0, SINGLE = 1 };
+
+    /**
+     * How Metropolis proposes a new angle. Uniform proposals draw a completely new angle on [0, 2PI). Adaptive proposals
+     * displace the current angle within a window, whose width is tuned towards a target acceptance rate before the
+     * first chunk of a configuration is measured and then kept for all following chunks.
+     */
+    enum ProposalMode { UNIFORM = 0, ADAPTIVE = 1 };
+
+    /**
+     * Per run options of the update algorithms which do not change the physics of the simulation.
+     */
+    struct Options {
+        Sweep sweep = SEQUENTIAL;
+        LatticeBase::Representation representation = LatticeBase::ANGLES;
+        Precision precision = DOUBLE;
+
+        /// The number of over-relaxation sweeps performed ahead of every Metropolis sweep
+        std::size_t over_relaxation = 0;
+
+        /// How Metropolis proposes new angles
+        ProposalMode proposal = UNIFORM;
+
+        /// The acceptance rate the width of adaptive proposals is tuned towards
+        double_t target_acceptance = 0.5;
+
+        /// The number of unrecorded sweeps spent on tuning the width of adaptive proposals
+        std::size_t tuning_sweeps = 1000;
+
+        /// The number of threads Metropolis may update a single lattice with. Set by the tasks, not by the config.
+        std::size_t threads = 1;
+
+        /// The number of sweeps after which the running observables are measured afresh on the lattice, 0 never does
+        std::size_t recompute_interval = 0;
+
+        /// Whether configurations of the same lattice size are simulated together with one replica per SIMD lane
+        bool batch = false;
+    };
+
     /**
      * Helper constant for calculating N * PI.
      *
@@ -20,7 +70,27 @@ namespace algorithms {
      */
     template<const std::size_t N> constexpr double_t N_PI = static_cast<double_t>(N) * std::numbers::pi;
 
-    std::unordered_map<observables::Type, std::vector<double_t>> simulate(Lattice & lattice, XoshiroCpp::Xoshiro256Plus & rng, std::size_t sweeps, Algorithm algorithm) noexcept;
+    /**
+     * The window Metropolis proposals are drawn from around the current angle together with the fraction of proposals
+     * which were accepted with it. A width of 2PI proposes a completely new angle.
+     */
+    struct ProposalWindow {
+        double_t width = N_PI<2>;
+        double_t acceptance = 0.0;
+
+        /// Whether the width was already tuned, e.g. by a previous chunk of the same configuration
+        bool tuned = false;
+    };
+
+    /**
+     * The instruction sets for which the lattice and the update kernels are compiled. The best one supported by the
+     * CPU is picked at runtime, so a single binary runs on every node.
+     */
+    enum Isa { SSE2 = 0, AVX2 = 1, AVX512 = 2 };
+
+    std::ostream& operator<<(std::ostream& out, Isa value);
+
+    std::unordered_map<observables::Type, std::tuple<double_t, double_t>> validate_precision(std::size_t length, double_t temperature, std::size_t sweeps, std::uint64_t seed, Algorithm algorithm, const Options & options) noexcept;
 }
 
 #endif //ALGORITHM_HPP
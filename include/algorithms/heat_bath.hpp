@@ -0,0 +1,17 @@
+#ifndef HEAT_BATH_HPP
+#define HEAT_BATH_HPP
+
+#include "algorithms/algorithms.hpp"
+#include "utils/random.hpp"
+
+namespace algorithms {
+    inline namespace XY_ISA {
+        template<typename T>
+        std::tuple<double_t, double_t, std::tuple<double_t, double_t>> heat_bath(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng) noexcept;
+
+        template<typename T>
+        std::tuple<double_t, double_t, std::tuple<double_t, double_t>> heat_bath_checkerboard(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng) noexcept;
+    }
+}
+
+#endif //HEAT_BATH_HPP
@@ -1,10 +1,25 @@
 #ifndef METROPOLIS_HPP
 #define METROPOLIS_HPP
 
+#include <span>
+
 #include "algorithms/algorithms.hpp"
+#include "batch_lattice.hpp"
+#include "utils/random.hpp"
 
 namespace algorithms {
-    std::tuple<double_t, double_t, std::tuple<double_t, double_t>> metropolis(Lattice & lattice, XoshiroCpp::Xoshiro256Plus & rng) noexcept;
+    inline namespace XY_ISA {
+        template<typename T>
+        std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> metropolis(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng, double_t width = N_PI<2>) noexcept;
+
+        template<typename T>
+        std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> metropolis_checkerboard(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng, double_t width = N_PI<2>) noexcept;
+
+        template<typename T>
+        std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> metropolis_parallel(BasicLattice<T> & lattice, std::span<utils::SimdXoshiro256Plus> streams, double_t width = N_PI<2>) noexcept;
+
+        std::tuple<BatchLattice::vector, BatchLattice::vector, std::tuple<BatchLattice::vector, BatchLattice::vector>, BatchLattice::vector> metropolis_batch(BatchLattice & lattice, utils::SimdXoshiro256Plus & rng) noexcept;
+    }
 }
 
 #endif //METROPOLIS_HPP
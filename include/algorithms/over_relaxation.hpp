@@ -0,0 +1,16 @@
+#ifndef OVER_RELAXATION_HPP
+#define OVER_RELAXATION_HPP
+
+#include "algorithms/algorithms.hpp"
+
+namespace algorithms {
+    inline namespace XY_ISA {
+        template<typename T>
+        std::tuple<double_t, double_t, std::tuple<double_t, double_t>> over_relaxation(BasicLattice<T> & lattice) noexcept;
+
+        template<typename T>
+        std::tuple<double_t, double_t, std::tuple<double_t, double_t>> over_relaxation_checkerboard(BasicLattice<T> & lattice) noexcept;
+    }
+}
+
+#endif //OVER_RELAXATION_HPP
@@ -0,0 +1,62 @@
+#ifndef REPLICA_EXCHANGE_HPP
+#define REPLICA_EXCHANGE_HPP
+
+#include <memory>
+
+#include "algorithms/simulator.hpp"
+
+namespace algorithms {
+	/**
+	 * Simulates one lattice size at several temperatures side by side and periodically proposes to exchange the
+	 * configurations of neighbouring temperatures. A configuration stuck in a slow low temperature state can escape by
+	 * travelling up to a high temperature and back, which decorrelates the low temperature chains far faster than
+	 * longer chains would. Each temperature still yields its own time series, measured on whichever replica currently
+	 * holds it.
+	 */
+	class ReplicaExchange {
+	public:
+		/**
+		 * @param length The side length of all lattices
+		 * @param temperatures The temperatures to simulate in ascending order
+		 * @param spins The initial spins for each temperature or std::nullopt for a random start
+		 * @param options The options of the simulators
+		 */
+		ReplicaExchange(std::size_t length, const std::vector<double_t> & temperatures, const std::vector<std::optional<std::vector<double_t>>> & spins, const Options & options);
+
+		/**
+		 * Runs all replicas in parallel for the given number of sweeps and attempts to swap neighbouring temperatures
+		 * after every interval. The pairs alternate between (0, 1), (2, 3), ... and (1, 2), (3, 4), ...
+		 *
+		 * @param rng The generator the replicas are seeded from and the swaps are decided with
+		 * @param sweeps The number of sweeps to simulate at every temperature
+		 * @param interval The number of sweeps between two exchange attempts
+		 * @param algorithm The algorithm to update the replicas with
+		 * @param sinks One sink per temperature in the order of the temperatures, which receives the observables of
+		 * whichever replica is currently simulated at it
+		 */
+		void simulate(XoshiroCpp::Xoshiro256Plus & rng, std::size_t sweeps, std::size_t interval, Algorithm algorithm, std::span<observables::Sink *> sinks);
+
+		/**
+		 * @param temperature The index of the temperature
+		 * @return The replica currently simulated at the given temperature.
+		 */
+		[[nodiscard]] Simulator & replica(std::size_t temperature) const;
+
+		/**
+		 * @return The fraction of attempted swaps which were accepted.
+		 */
+		[[nodiscard]] double_t swap_acceptance() const noexcept;
+
+	private:
+		std::size_t num_sites;
+		std::vector<double_t> betas;
+		std::vector<std::unique_ptr<Simulator>> replicas;
+
+		/// The index of the replica currently simulated at each temperature
+		std::vector<std::size_t> slots;
+
+		std::size_t attempted_swaps = 0, accepted_swaps = 0;
+	};
+}
+
+#endif //REPLICA_EXCHANGE_HPP
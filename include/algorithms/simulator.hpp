@@ -0,0 +1,119 @@
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+
+#include <memory>
+#include <span>
+
+#include "algorithms/algorithms.hpp"
+
+namespace algorithms {
+    /**
+     * A lattice together with the update kernels of one instruction set and precision. The tasks only talk to this
+     * interface, so the kernels are picked at runtime and the lattice types of the different instruction sets never
+     * leave the translation units they are compiled in.
+     */
+    class Simulator {
+    public:
+        virtual ~Simulator() = default;
+
+        /**
+         * Starts a new run, which seeds the random streams from the generator, tunes the proposal window if needed and
+         * measures the observables of the lattice.
+         */
+        virtual void start(XoshiroCpp::Xoshiro256Plus & rng, Algorithm algorithm) = 0;
+
+        /**
+         * Continues the current run for the given number of sweeps and pushes the observables of every sweep into the
+         * sink. Everything set up by start is kept from one call to the next, so stretches of sweeps interleaved with
+         * other work, like the exchanges of replicas, only pay for the sweeps themselves.
+         */
+        virtual void advance(std::size_t sweeps, observables::Sink & sink) = 0;
+
+        /**
+         * Simulates the given number of sweeps in a new run and pushes the observables of every sweep into the sink.
+         */
+        void simulate(XoshiroCpp::Xoshiro256Plus & rng, const std::size_t sweeps, const Algorithm algorithm, observables::Sink & sink) {
+            start(rng, algorithm);
+            advance(sweeps, sink);
+        }
+
+        /**
+         * @return The complete time series of every observable.
+         */
+        std::unordered_map<observables::Type, std::vector<double_t>> simulate(XoshiroCpp::Xoshiro256Plus & rng, const std::size_t sweeps, const Algorithm algorithm) {
+            observables::Series series { sweeps };
+            simulate(rng, sweeps, algorithm, series);
+            return series.release();
+        }
+
+        virtual void set_beta(double_t beta) = 0;
+
+        /**
+         * Continues with the width of the Metropolis proposals tuned by a previous chunk instead of tuning it again.
+         *
+         * @param width The tuned width of the proposal window
+         */
+        virtual void set_proposal_width(double_t width) = 0;
+
+        /**
+         * @return The proposal window of the current run and the acceptance rate measured with it so far.
+         */
+        [[nodiscard]] virtual ProposalWindow get_proposal_window() const = 0;
+
+        [[nodiscard]] virtual std::vector<double_t> get_spins() const = 0;
+    };
+
+    /**
+     * One register worth of lattices of the same size which are updated together, one replica per SIMD lane. Only
+     * uniform Metropolis sweeps in double precision are batched, see supports_batch.
+     */
+    class BatchSimulator {
+    public:
+        virtual ~BatchSimulator() = default;
+
+        /**
+         * Simulates the given number of sweeps and pushes the observables of every replica into its own sink.
+         *
+         * @param sinks One sink per replica in the order the replicas were created in
+         */
+        virtual void simulate(XoshiroCpp::Xoshiro256Plus & rng, std::size_t sweeps, std::span<observables::Sink *> sinks) = 0;
+
+        /**
+         * @return The proposal window of the given replica and the acceptance rate measured with it during the last call to simulate.
+         */
+        [[nodiscard]] virtual ProposalWindow get_proposal_window(std::size_t replica) const = 0;
+
+        [[nodiscard]] virtual std::vector<double_t> get_spins(std::size_t replica) const = 0;
+    };
+
+    [[nodiscard]] Isa detect_isa() noexcept;
+
+    [[nodiscard]] std::unique_ptr<Simulator> make_simulator(std::size_t length, double_t beta, const std::optional<std::vector<double_t>> & spins, const Options & options);
+
+    /**
+     * @return Whether chunks of the given algorithm and options may be simulated in batches.
+     */
+    [[nodiscard]] bool supports_batch(Algorithm algorithm, const Options & options) noexcept;
+
+    /**
+     * @return Whether the given algorithm updates a single lattice on more than one thread if it is lent them.
+     */
+    [[nodiscard]] bool supports_threads(Algorithm algorithm) noexcept;
+
+    /**
+     * @return The number of replicas a batch of the best instruction set supported by the CPU holds.
+     */
+    [[nodiscard]] std::size_t batch_width() noexcept;
+
+    [[nodiscard]] std::unique_ptr<BatchSimulator> make_batch_simulator(std::size_t length, const std::vector<double_t> & betas, const std::vector<std::optional<std::vector<double_t>>> & spins, const Options & options);
+
+    inline namespace XY_ISA {
+        [[nodiscard]] std::unique_ptr<Simulator> create_simulator(std::size_t length, double_t beta, const std::optional<std::vector<double_t>> & spins, const Options & options);
+
+        [[nodiscard]] std::unique_ptr<BatchSimulator> create_batch_simulator(std::size_t length, const std::vector<double_t> & betas, const std::vector<std::optional<std::vector<double_t>>> & spins, const Options & options);
+
+        [[nodiscard]] std::size_t batch_replicas() noexcept;
+    }
+}
+
+#endif //SIMULATOR_HPP
@@ -0,0 +1,30 @@
+#ifndef SWENDSEN_WANG_HPP
+#define SWENDSEN_WANG_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "algorithms/algorithms.hpp"
+#include "utils/random.hpp"
+
+namespace algorithms {
+    inline namespace XY_ISA {
+        /**
+         * Reusable memory for labeling the Swendsen-Wang clusters of a lattice, i.e. the union-find forest over all sites
+         * and the projections of the spins onto the reflection axis of the current sweep.
+         */
+        struct ClusterForest {
+            explicit ClusterForest(const std::size_t num_sites) : parents(num_sites), projections(num_sites) {
+
+            }
+
+            std::vector<std::uint32_t> parents;
+            std::vector<double_t> projections;
+        };
+
+        template<typename T>
+        void swendsen_wang(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng, ClusterForest & forest) noexcept;
+    }
+}
+
+#endif //SWENDSEN_WANG_HPP
@@ -1,10 +1,70 @@
 #ifndef WOLFF_HPP
 #define WOLFF_HPP
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "algorithms/algorithms.hpp"
+#include "utils/random.hpp"
 
 namespace algorithms {
-    std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::int32_t, std::size_t> wolff(Lattice & lattice, XoshiroCpp::Xoshiro256Plus & rng) noexcept;
+    inline namespace XY_ISA {
+        /**
+         * Reusable memory for growing Wolff clusters. Sites are marked as visited by stamping them with the generation
+         * of the current cluster, so starting a new cluster only increments the generation instead of clearing the
+         * marks. Every site enters the cluster at most once, so a stack with room for all sites never has to grow.
+         */
+        class ClusterWorkspace {
+        public:
+            explicit ClusterWorkspace(const std::size_t num_sites) : stamps(num_sites, 0), stack(num_sites) {
+
+            }
+
+            /**
+             * Starts a new cluster by invalidating all visited marks of the previous one.
+             */
+            void reset() noexcept {
+                if (++generation == 0) [[unlikely]] {
+                    // The stamps wrapped around, so old marks could be mistaken for new ones
+                    std::ranges::fill(stamps, 0);
+                    generation = 1;
+                }
+                top = 0;
+            }
+
+            /**
+             * Marks the given site as visited and pushes it onto the stack.
+             *
+             * @param i The site to add to the cluster
+             */
+            void push(const std::size_t i) noexcept {
+                stamps[i] = generation;
+                stack[top++] = i;
+            }
+
+            std::size_t pop() noexcept {
+                return stack[--top];
+            }
+
+            [[nodiscard]] bool empty() const noexcept {
+                return top == 0;
+            }
+
+            [[nodiscard]] bool visited(const std::size_t i) const noexcept {
+                return stamps[i] == generation;
+            }
+
+        private:
+            std::vector<std::uint32_t> stamps;
+            std::vector<std::size_t> stack;
+            std::size_t top = 0;
+            std::uint32_t generation = 0;
+        };
+
+        template<typename T>
+        std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::int32_t, std::size_t> wolff(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng, ClusterWorkspace & workspace) noexcept;
+    }
 }
 
 #endif //WOLFF_HPP
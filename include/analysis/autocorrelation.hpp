@@ -2,12 +2,46 @@
 #define AUTOCORRELATION_HPP
 
 #include <cmath>
+#include <filesystem>
 #include <tuple>
 #include <vector>
 #include <span>
 
 namespace analysis {
-	std::tuple<double_t, std::vector<double_t>> integrated_autocorrelation_time(const std::span<double_t> & data);
+	/**
+	 * The ways to estimate the autocorrelation of a chunk. The FFT transforms the recorded time series after the chunk,
+	 * while the multi-tau correlator is updated during the sweeps and only evaluated at the end.
+	 */
+	enum Estimator { FFT = 0, MULTI_TAU = 1 };
+
+	std::tuple<double_t, std::vector<double_t>> integrated_autocorrelation_time(const std::span<const double_t> & data);
+
+	/**
+	 * Estimates the autocorrelation around a mean known from more values than the given ones, e.g. when only the most
+	 * recent part of a time series was kept.
+	 */
+	std::tuple<double_t, std::vector<double_t>> integrated_autocorrelation_time(const std::span<const double_t> & data, double_t mean);
+
+	/**
+	 * Integrates an autocorrelation function known at logarithmically spaced lags, e.g. of a multi-tau correlator. Every
+	 * lag stands in for all lags up to the next one.
+	 *
+	 * @param correlation The lags and the normalized autocorrelation function at each of them, starting at lag zero
+	 * @return The integrated autocorrelation time and the positive part of the autocorrelation function interpolated
+	 * onto every lag.
+	 */
+	std::tuple<double_t, std::vector<double_t>> integrated_autocorrelation_time(const std::span<const std::tuple<std::size_t, double_t>> & correlation);
+
+	/**
+	 * Loads the FFTW plans measured by earlier runs, if the file exists. Plans are only valid on the hardware they were
+	 * measured on, so every host keeps its own file.
+	 */
+	void load_wisdom(const std::filesystem::path & path);
+
+	/**
+	 * Saves the FFTW plans measured so far, so later runs do not have to measure them again.
+	 */
+	void save_wisdom(const std::filesystem::path & path);
 }
 
 #endif //AUTOCORRELATION_HPP
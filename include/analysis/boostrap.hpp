@@ -1,15 +1,86 @@
 #ifndef BOOSTRAP_HPP
 #define BOOSTRAP_HPP
 
+#include <array>
+#include <map>
+#include <optional>
 #include <tuple>
 #include <span>
 #include <random>
 #include <XoshiroCpp.hpp>
 
+#include "observables/type.hpp"
+
 namespace analysis {
-    std::vector<double_t> thermalize_and_block(const std::span<double_t> & data, double_t tau, bool skip_thermalization = false);
+    /**
+     * The ways to bootstrap the estimates of a configuration. Independently every observable is resampled on its own
+     * and the derived observables are propagated from the estimates afterwards, while jointly all observables share
+     * the indices of every resample and the derived observables are computed from each resample.
+     */
+    enum BootstrapMode { INDEPENDENT = 0, JOINT = 1 };
+
+    /**
+     * The ways to estimate the error of the mean of a blocked time series. The bootstrap draws resamples of the blocks,
+     * while the jackknife leaves out one bin at a time after a binning analysis chose the size of the bins.
+     */
+    enum ErrorEstimator { BOOTSTRAP = 0, JACKKNIFE = 1 };
+
+    /// The mean, the standard deviation, the block size if the estimator chose one and the number of resamples if the
+    /// estimator drew any of every observable
+    using Estimates = std::map<observables::Type, std::tuple<double_t, double_t, std::optional<std::size_t>, std::optional<std::size_t>>>;
+
+    /// The derived observables and the two observables each of them is computed from
+    inline constexpr std::array<std::tuple<observables::Type, observables::Type, observables::Type>, 3> DERIVED {{
+        { observables::SpecificHeat, observables::Energy, observables::EnergySquared },
+        { observables::MagneticSusceptibility, observables::Magnetization, observables::MagnetizationSquared },
+        { observables::HelicityModulus, observables::HelicityModulusIntermediate, observables::Energy }
+    }};
+
+    /**
+     * Computes a derived observable from the means of the two observables of DERIVED it is computed from.
+     */
+    double_t derive(observables::Type type, double_t temperature, double_t first, double_t second);
+
+    std::vector<double_t> thermalize_and_block(const std::span<const double_t> & data, double_t tau, bool skip_thermalization = false);
+
+    /**
+     * Rebins the blocks of every observable onto as many bins as the observable with the fewest blocks has, so the same
+     * index refers to roughly the same stretch of sweeps in all of them. The observables hold different numbers of
+     * blocks because each of them is blocked with its own autocorrelation time.
+     *
+     * @return The sum of the blocks and the number of blocks in every bin, one pair of columns per observable. The mean
+     * of a selection of bins is the ratio of the two, which weights every block equally however the blocks are spread
+     * over the bins.
+     */
+    std::vector<std::vector<double_t>> align_blocks(const std::vector<std::span<const double_t>> & series);
+
+    /**
+     * Bootstraps the mean of a blocked time series. The resamples are drawn in batches until the standard deviation is
+     * known to the given relative tolerance, so well-behaved series stop after a fraction of the maximum number.
+     *
+     * @param rng The generator of the resamples
+     * @param blocked The blocked time series
+     * @param n The maximum number of resamples
+     * @param tolerance The relative standard error the standard deviation has to reach, or 0 to draw all n resamples
+     * @return The mean, its standard deviation and the number of resamples drawn.
+     */
+    std::tuple<double_t, double_t, std::size_t> bootstrap_blocked(XoshiroCpp::Xoshiro256Plus & rng, const std::vector<double_t> & blocked, std::size_t n, double_t tolerance = 0.0);
 
-    std::tuple<double_t, double_t> bootstrap_blocked(XoshiroCpp::Xoshiro256Plus & rng, const std::vector<double_t> & blocked, std::size_t n);
+    /**
+     * Bootstraps all observables of a configuration with the same resample indices and derives the specific heat, the
+     * magnetic susceptibility and the helicity modulus from every resample, so their errors include the correlations
+     * between the observables they are computed from.
+     *
+     * @param rng The generator of the resamples
+     * @param blocked The blocked time series of every observable
+     * @param temperature The temperature of the configuration
+     * @param n The maximum number of resamples
+     * @param tolerance The relative standard error the standard deviation of every observable has to reach, or 0 to
+     * draw all n resamples
+     * @return The mean, the standard deviation and the number of resamples drawn of every observable, including the
+     * derived ones whose inputs are given.
+     */
+    Estimates bootstrap_joint(XoshiroCpp::Xoshiro256Plus & rng, const std::map<observables::Type, std::vector<double_t>> & blocked, double_t temperature, std::size_t n, double_t tolerance = 0.0);
 }
 
 #endif //BOOSTRAP_HPP
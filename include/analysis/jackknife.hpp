@@ -0,0 +1,36 @@
+#ifndef JACKKNIFE_HPP
+#define JACKKNIFE_HPP
+
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "analysis/boostrap.hpp"
+
+namespace analysis {
+    /**
+     * Estimates the error of the mean of a blocked time series with a jackknife over bins of consecutive blocks. The
+     * size of the bins is chosen by a Flyvbjerg-Petersen binning analysis: the bins are doubled in size until the
+     * standard error of the mean stops growing beyond its own uncertainty, which is where they are uncorrelated. Series
+     * of fewer than two blocks are rejected with std::invalid_argument, since leaving out their only bin leaves nothing.
+     *
+     * @param blocked The blocked time series
+     * @return The mean, its standard deviation and the number of blocks per bin.
+     */
+    std::tuple<double_t, double_t, std::size_t> jackknife_binned(std::span<const double_t> blocked);
+
+    /**
+     * Estimates all observables of a configuration with a jackknife over the same bins and derives the specific heat,
+     * the magnetic susceptibility and the helicity modulus from every jackknife sample. The bins are as large as the
+     * binning analysis requires for the most strongly correlated observable. Every observable needs at least two blocks,
+     * otherwise std::invalid_argument is thrown.
+     *
+     * @param blocked The blocked time series of every observable
+     * @param temperature The temperature of the configuration
+     * @return The mean, the standard deviation and the number of blocks per bin of every observable, including the
+     * derived ones whose inputs are given.
+     */
+    Estimates jackknife_joint(const std::map<observables::Type, std::vector<double_t>> & blocked, double_t temperature);
+}
+
+#endif //JACKKNIFE_HPP
@@ -0,0 +1,39 @@
+#ifndef RESAMPLE_HPP
+#define RESAMPLE_HPP
+
+#include <array>
+#include <span>
+#include <tuple>
+#include <XoshiroCpp.hpp>
+
+#include "utils/simd.hpp"
+
+namespace analysis {
+    inline namespace XY_ISA {
+        /**
+         * Draws resamples of the blocks with replacement and sums up their means. The indices of a resample are drawn in
+         * bulk as bounded integers and the blocks are gathered and summed up a whole register at a time.
+         *
+         * @param rng The generator the SIMD streams of the resamples are seeded from
+         * @param blocked The blocked time series
+         * @param resamples The number of resamples to draw
+         * @param shift The value subtracted from the mean of every resample, usually the mean of the blocks, which
+         * keeps the sums of the powers from cancelling out
+         * @return The sums of the first four powers of the shifted means.
+         */
+        std::array<double_t, 4> resample(XoshiroCpp::Xoshiro256Plus & rng, std::span<const double_t> blocked, std::size_t resamples, double_t shift) noexcept;
+
+        /**
+         * Draws resamples of several blocked time series of equal length with the same indices for all of them, so the
+         * means of every resample keep the correlations between the series.
+         *
+         * @param rng The generator the SIMD streams of the resamples are seeded from
+         * @param columns The blocked time series, which all hold the same number of blocks
+         * @param resamples The number of resamples to draw
+         * @param means The mean of every series in every resample, one row of columns.size() means per resample
+         */
+        void resample_means(XoshiroCpp::Xoshiro256Plus & rng, std::span<const std::span<const double_t>> columns, std::size_t resamples, std::span<double_t> means) noexcept;
+    }
+}
+
+#endif //RESAMPLE_HPP
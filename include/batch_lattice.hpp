@@ -0,0 +1,106 @@
+#ifndef BATCH_LATTICE_HPP
+#define BATCH_LATTICE_HPP
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include "lattice.hpp"
+#include "utils/utils.hpp"
+#include "utils/simd.hpp"
+
+inline namespace XY_ISA {
+    /**
+     * One register worth of independent square lattices of XY spins with the same side length, typically at different
+     * temperatures. The spins of all replicas are interleaved per site as [replicas * i + replica], so the value of a site
+     * in every replica is a single aligned load and the neighbours of a site are reached through the neighbour table
+     * without any gather. Each lane of a register belongs to one replica, which makes the replicas advance in lockstep
+     * through the same site order while their accept/reject decisions are made independently.
+     *
+     * The cosine and sine of every spin are always kept next to the angles, so the update kernels get by with a single
+     * sincos per proposal.
+     */
+    class BatchLattice : public LatticeBase {
+    public:
+        using simd = utils::simd<double_t>;
+        using vector = simd::vector;
+
+        /// The number of replicas, one per lane of a register
+        static constexpr std::size_t replicas = simd::lanes;
+
+        /// One double precision value per replica
+        using values = std::array<double_t, replicas>;
+
+        /**
+         * @param length The side length shared by all replicas
+         * @param betas The inverse temperature of every replica. Unused lanes are filled with the last given one.
+         * @param spins The initial spins of every replica or none for a cold lattice
+         */
+        BatchLattice(std::size_t length, const std::vector<double_t> & betas, const std::vector<std::optional<std::vector<double_t>>> & spins);
+
+        [[nodiscard]] constexpr std::size_t side_length() const noexcept {
+            return length;
+        }
+
+        [[nodiscard]] constexpr std::size_t num_sites() const noexcept {
+            return length * length;
+        }
+
+        void set_beta(std::size_t replica, double_t beta) noexcept;
+
+        [[nodiscard]] std::size_t neighbour(const std::size_t i, const Direction direction) const noexcept {
+            return static_cast<std::size_t>(neighbour_table[4 * i + direction]);
+        }
+
+        [[nodiscard]] Proposal<vector> propose(vector angles) const noexcept;
+
+        /**
+         * Sums up the unit vectors of the four neighbours of a site in every replica.
+         *
+         * @param i The index of the site
+         * @return The cosine and sine components of the local fields.
+         */
+        [[nodiscard]] std::tuple<vector, vector> local_field(std::size_t i) const noexcept;
+
+        /**
+         * Writes the proposals of the lanes set in the mask to the site and keeps the old spins in all other lanes.
+         */
+        void set(std::size_t i, const Proposal<vector> & proposals, simd::mask mask) noexcept;
+
+        [[nodiscard]] vector energy_diff(std::size_t i, const Proposal<vector> & proposals) const noexcept;
+        [[nodiscard]] vector helicity_modulus_diff(std::size_t i, const Proposal<vector> & proposals) const noexcept;
+        [[nodiscard]] std::tuple<vector, vector> magnetization_diff(std::size_t i, const Proposal<vector> & proposals) const noexcept;
+        [[nodiscard]] vector acceptance(vector energy_diff) const noexcept;
+
+        /**
+         * Measures the energy, the helicity modulus and the magnetization of every replica in a single pass over the
+         * lattice, which loads the unit vectors of each site and its right neighbour once for all of them.
+         *
+         * @return The energy, the helicity modulus and the cosine and sine components of the magnetization, one lane per replica.
+         */
+        [[nodiscard]] std::tuple<vector, vector, std::tuple<vector, vector>> observables() const noexcept;
+
+        [[nodiscard]] std::vector<double_t> get_spins(std::size_t replica) const noexcept;
+
+        /// Spills the lanes of a register into one value per replica
+        [[nodiscard]] static values split(vector v) noexcept;
+
+    private:
+        const std::size_t length;
+
+        /// The negated inverse temperature of every replica, ready to be multiplied onto the energy differences
+        alignas(64) std::array<double_t, replicas> negative_betas {};
+
+        /// The angles, cosines and sines of all replicas laid out as [replicas * i + replica]
+        utils::aligned_vector<double_t> spins, cosines, sines;
+
+        /// The indices of the four nearest neighbours of every site laid out as [4 * i + direction]
+        utils::aligned_vector<int32_t> neighbour_table;
+
+        [[nodiscard]] vector load(const utils::aligned_vector<double_t> & array, const std::size_t i) const noexcept {
+            return simd::load(array.data() + replicas * i);
+        }
+    };
+}
+
+#endif //BATCH_LATTICE_HPP
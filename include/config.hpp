@@ -3,9 +3,12 @@
 
 #include <cstddef>
 #include <map>
+#include <optional>
 #include <unordered_set>
 
 #include "algorithms/algorithms.hpp"
+#include "analysis/autocorrelation.hpp"
+#include "analysis/boostrap.hpp"
 
 enum StorageEngine {
 	SQLiteEngine = 1,
@@ -16,6 +19,19 @@ struct AlgorithmConfig {
 	const std::size_t num_chunks;
 	const std::size_t sweeps_per_chunk;
 	const std::unordered_set<std::size_t> sizes;
+	const algorithms::Options options;
+
+	/// The number of sweeps between two replica exchanges of neighbouring temperatures or 0 for independent chains
+	const std::size_t exchange_interval;
+};
+
+struct ValidationConfig {
+	const std::unordered_set<std::size_t> sizes;
+	const double_t temperature;
+
+	/// The number of sweeps per simulation, of which the second half is averaged, so at least 2
+	const std::size_t sweeps;
+	const std::uint64_t seed;
 };
 
 struct Config {
@@ -27,6 +43,27 @@ struct Config {
 	const int32_t simulation_id;
 	const std::size_t bootstrap_resamples;
 
+	/// The relative standard error the bootstrapped standard deviations have to reach before no further resamples are drawn
+	const double_t bootstrap_tolerance;
+
+	/// Whether the observables of a configuration are bootstrapped one by one or all together
+	const analysis::BootstrapMode bootstrap;
+
+	/// How the error of every estimate is computed, which is kept per simulation in the storage
+	const analysis::ErrorEstimator error_estimator;
+
+	/// The number of most recent sweeps the autocorrelation time of a later chunk of a configuration is estimated from
+	const std::size_t autocorrelation_window;
+
+	/// The maximum number of blocks a later chunk of a configuration keeps per observable
+	const std::size_t max_blocks;
+
+	/// How the autocorrelation time of every chunk is estimated
+	const analysis::Estimator autocorrelation;
+
+	/// The directory the FFTW wisdom of every host is kept in
+	const std::string wisdom_directory;
+
 	const int32_t max_temperature;
 	const int32_t temperature_steps;
 	const double_t max_depth;
@@ -34,6 +71,10 @@ struct Config {
 	const std::unordered_set<std::size_t> vortex_sizes;
 
 	const std::map<algorithms::Algorithm, AlgorithmConfig> algorithms;
+
+	const std::optional<ValidationConfig> validation;
+
+	[[nodiscard]] algorithms::Options options(algorithms::Algorithm algorithm) const;
 };
 
 #endif //CONFIG_HPP
@@ -3,61 +3,230 @@
 
 #include <optional>
 #include <vector>
+#include <simde/x86/avx2.h>
 
 #include "utils/utils.hpp"
-
-class Lattice {
-public:
-    Lattice(std::size_t length, double_t beta, const std::optional<std::vector<double_t>> & spins);
-
-    [[nodiscard]] constexpr std::size_t side_length() const noexcept {
-        return length;
-    }
-
-    [[nodiscard]] constexpr std::size_t num_sites() const noexcept {
-        return length * length;
-    }
-
-    [[nodiscard]] double_t get_beta() const noexcept {
-        return beta;
-    }
-
-    void set_beta(const double_t pBeta) noexcept {
-        this->beta = pBeta;
-    }
-
-    [[nodiscard]] constexpr std::size_t shift_row(const std::size_t i, const int32_t delta) const noexcept {
-        const auto sites = num_sites();
-        return (i + sites + delta * length) % sites;
-    }
-
-    [[nodiscard]] constexpr std::size_t shift_col(const std::size_t i, const int32_t delta) const noexcept {
-        const auto sites = num_sites();
-        const auto row = i % sites / length * length;
-        const auto col = (i % length + length + delta) % length;
-        return row + col;
-    }
-
-    void set(std::size_t i, double_t angle) noexcept;
-    double operator[] (const std::size_t i) const { return spins[i]; }
-
-    [[nodiscard]] double_t energy() const noexcept;
-    [[nodiscard]] double_t energy_diff(std::size_t i, double_t angle) const noexcept;
-
-    [[nodiscard]] double_t helicity_modulus() const noexcept;
-    [[nodiscard]] double_t helicity_modulus_diff(std::size_t i, double_t angle) const noexcept;
-
-    [[nodiscard]] std::tuple<double_t, double_t> magnetization() const noexcept;
-    [[nodiscard]] std::tuple<double_t, double_t> magnetization_diff(std::size_t i, double_t angle) const noexcept;
-
-    [[nodiscard]] double_t acceptance(double_t energy_diff) const noexcept;
-
-    [[nodiscard]] std::vector<double_t> get_spins() const noexcept;
-
-private:
-    double_t beta;
-    const std::size_t length;
-    utils::aligned_vector<double_t> spins;
+#include "utils/simd.hpp"
+
+/**
+ * The members of the lattice which depend neither on the precision of the spins nor on the instruction set.
+ */
+struct LatticeBase {
+    /// The four nearest neighbours of a site in the order they are stored in the neighbour table.
+    enum Direction { RIGHT = 0, LEFT = 1, DOWN = 2, UP = 3 };
+
+    /**
+     * The way the spins are represented in memory. The angles are always stored as they are serialized into the
+     * chunks. With unit vectors the cosine and sine of every spin are additionally kept in two separate arrays, so the
+     * bond energies become dot products and the kernels get by without any trigonometric function.
+     */
+    enum Representation { ANGLES = 0, UNIT_VECTORS = 1 };
 };
 
+inline namespace XY_ISA {
+    /**
+     * A proposed angle for one or more lattice sites. When the lattice keeps unit vectors the cosine and sine of the angle
+     * are evaluated once on creation, so every kernel evaluating the proposal can share them.
+     *
+     * @tparam T Either a scalar double or a SIMD vector holding one proposal per lane
+     */
+    template<typename T>
+    struct Proposal {
+        T angle;
+        T cos;
+        T sin;
+    };
+
+    /**
+     * The change of every observable a proposal would make. All of them are built from the unit vectors of the site, the
+     * proposal and the four neighbours, so evaluating them together needs each of these sines and cosines only once.
+     *
+     * @tparam T Either a scalar double or a SIMD vector holding the changes of one proposal per lane
+     */
+    template<typename T>
+    struct Changes {
+        T energy;
+        T helicity_modulus;
+        T magnet_cos;
+        T magnet_sin;
+    };
+
+    /**
+     * A square lattice of XY spins with periodic boundaries. The spins are stored in the scalar type T, while every
+     * observable and every per-site difference is handed out in double precision, so the running observables of a
+     * simulation are always accumulated in double precision. The SIMD kernels process utils::simd<T>::lanes sites at once.
+     *
+     * @tparam T The scalar type of the spins (float or double)
+     */
+    template<typename T>
+    class BasicLattice : public LatticeBase {
+    public:
+        using simd = utils::simd<T>;
+        using vector = typename simd::vector;
+        using index = typename simd::index;
+
+        BasicLattice(std::size_t length, double_t beta, const std::optional<std::vector<double_t>> & spins, Representation representation = ANGLES);
+
+        [[nodiscard]] constexpr std::size_t side_length() const noexcept {
+            return length;
+        }
+
+        [[nodiscard]] constexpr std::size_t num_sites() const noexcept {
+            return length * length;
+        }
+
+        [[nodiscard]] double_t get_beta() const noexcept {
+            return beta;
+        }
+
+        void set_beta(const double_t pBeta) noexcept {
+            this->beta = pBeta;
+        }
+
+        [[nodiscard]] Representation get_representation() const noexcept {
+            return representation;
+        }
+
+        [[nodiscard]] constexpr std::size_t shift_row(const std::size_t i, const int32_t delta) const noexcept {
+            const auto sites = num_sites();
+            return (i + sites + delta * length) % sites;
+        }
+
+        [[nodiscard]] constexpr std::size_t shift_col(const std::size_t i, const int32_t delta) const noexcept {
+            const auto sites = num_sites();
+            const auto row = i % sites / length * length;
+            const auto col = (i % length + length + delta) % length;
+            return row + col;
+        }
+
+        /**
+         * Maps the k-th site of the given sublattice onto its index in the underlying vector. The sites of the checkerboard
+         * are colored by the parity of row + col, so no two sites of the same sublattice are nearest neighbours.
+         *
+         * @param color The sublattice (0 or 1)
+         * @param k The index of the site within the sublattice on [0, L^2 / 2)
+         * @return The index of the site in the underlying vector.
+         */
+        [[nodiscard]] constexpr std::size_t sublattice_site(const std::size_t color, const std::size_t k) const noexcept {
+            const auto half = length / 2;
+            const auto row = k / half;
+            return row * length + 2 * (k % half) + ((row + color) & 1);
+        }
+
+        /**
+         * Looks up the nearest neighbour of a site in the precomputed neighbour table. Unlike shift_row and shift_col this
+         * requires no integer division, which makes it the preferred way of addressing neighbours in the update kernels.
+         *
+         * @param i The index of the site
+         * @param direction The direction of the neighbour
+         * @return The index of the neighbouring site in the underlying vector.
+         */
+        [[nodiscard]] std::size_t neighbour(const std::size_t i, const Direction direction) const noexcept {
+            return neighbour_table[4 * i + direction];
+        }
+
+        [[nodiscard]] index sublattice_sites(std::size_t color, std::size_t k) const noexcept;
+
+        [[nodiscard]] Proposal<double_t> propose(double_t angle) const noexcept;
+        [[nodiscard]] Proposal<vector> propose(vector angles) const noexcept;
+
+        /**
+         * Sums up the unit vectors of the four neighbours of a site. The local field determines the conditional
+         * distribution of the spin at the site, which is what the over-relaxation and heat bath moves are built on.
+         *
+         * @param i The index of the site
+         * @return The cosine and sine components of the local field.
+         */
+        [[nodiscard]] std::tuple<double_t, double_t> local_field(std::size_t i) const noexcept;
+        [[nodiscard]] std::tuple<vector, vector> local_field(index sites) const noexcept;
+
+        /**
+         * Reflects the spin of a site about the local field of its four neighbours, i.e. maps the angle a onto 2 * phi - a
+         * where phi is the angle of the sum of the neighbouring unit vectors. The reflection leaves the bond energies of
+         * the site unchanged, which makes it the microcanonical over-relaxation move.
+         *
+         * @param i The index of the site
+         * @return The reflected spin as a proposal, which can be evaluated and set like any other proposal.
+         */
+        [[nodiscard]] Proposal<double_t> reflect(std::size_t i) const noexcept;
+        [[nodiscard]] Proposal<vector> reflect(index sites) const noexcept;
+
+        /**
+         * Rotates the spin of a site by the given angle and wraps the result back onto [0, 2PI).
+         *
+         * @param i The index of the site
+         * @param delta The angle to rotate the spin by on [-PI, PI)
+         * @return The rotated spin as a proposal.
+         */
+        [[nodiscard]] Proposal<double_t> displace(std::size_t i, double_t delta) const noexcept;
+        [[nodiscard]] Proposal<vector> displace(index sites, vector deltas) const noexcept;
+
+        void set(std::size_t i, double_t angle) noexcept;
+        void set(std::size_t i, const Proposal<double_t> & proposal) noexcept;
+        void set(index sites, const Proposal<vector> & proposals, int32_t mask) noexcept;
+        double_t operator[] (const std::size_t i) const { return spins[i]; }
+
+        [[nodiscard]] double_t energy_diff(std::size_t i, const Proposal<double_t> & proposal) const noexcept;
+        [[nodiscard]] vector energy_diff(index sites, const Proposal<vector> & proposals) const noexcept;
+
+        [[nodiscard]] double_t helicity_modulus_diff(std::size_t i, const Proposal<double_t> & proposal) const noexcept;
+        [[nodiscard]] vector helicity_modulus_diff(index sites, const Proposal<vector> & proposals) const noexcept;
+
+        [[nodiscard]] std::tuple<double_t, double_t> magnetization() const noexcept;
+        [[nodiscard]] std::tuple<double_t, double_t> magnetization_diff(std::size_t i, const Proposal<double_t> & proposal) const noexcept;
+        [[nodiscard]] std::tuple<vector, vector> magnetization_diff(index sites, const Proposal<vector> & proposals) const noexcept;
+
+        /**
+         * Evaluates the energy, helicity modulus and magnetization difference of a proposal in one go.
+         *
+         * @param i The index of the site
+         * @param proposal The proposed spin
+         * @return The changes the proposal would make.
+         */
+        [[nodiscard]] Changes<double_t> changes(std::size_t i, const Proposal<double_t> & proposal) const noexcept;
+        [[nodiscard]] Changes<vector> changes(index sites, const Proposal<vector> & proposals) const noexcept;
+
+        /**
+         * Measures the energy, the helicity modulus and the magnetization in a single pass over the lattice. With angles
+         * the unit vector of every site is evaluated once, instead of once per bond and observable. Rows which fill whole
+         * registers are streamed with contiguous loads, so the pass is bound by memory bandwidth rather than by gathers.
+         *
+         * @return The energy, the helicity modulus and the cosine and sine components of the magnetization.
+         */
+        [[nodiscard]] std::tuple<double_t, double_t, std::tuple<double_t, double_t>> observables() const noexcept;
+
+        [[nodiscard]] double_t acceptance(double_t energy_diff) const noexcept;
+        [[nodiscard]] vector acceptance(vector energy_diff) const noexcept;
+
+        [[nodiscard]] std::vector<double_t> get_spins() const noexcept;
+
+    private:
+        double_t beta;
+        const std::size_t length;
+        const Representation representation;
+        utils::aligned_vector<T> spins;
+
+        /// The cosine and sine of every spin. Only populated for the unit vector representation.
+        utils::aligned_vector<T> cosines, sines;
+
+        /// The indices of the four nearest neighbours of every site laid out as [4 * i + direction]
+        utils::aligned_vector<int32_t> neighbour_table;
+
+        /// The indices of all sites of the first sublattice followed by all sites of the second sublattice
+        utils::aligned_vector<int32_t> sublattice_table;
+
+        [[nodiscard]] std::tuple<vector, vector, vector, vector> neighbours(const utils::aligned_vector<T> & values, index sites) const noexcept;
+        [[nodiscard]] simde__m256d neighbours_pd(const utils::aligned_vector<T> & values, std::size_t i) const noexcept;
+
+        /// Wraps arbitrary angles onto [0, 2PI)
+        [[nodiscard]] static vector wrap(vector angles) noexcept;
+    };
+
+    /// The double precision lattice used by default
+    using Lattice = BasicLattice<double_t>;
+
+    /// The single precision lattice which processes twice as many sites per SIMD register
+    using LatticeF = BasicLattice<float>;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,201 @@
+#ifndef SINK_HPP
+#define SINK_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "observables/type.hpp"
+
+namespace observables {
+	/**
+	 * Receives the measurements of a simulation sweep by sweep. The sweep loops push every observable once per sweep
+	 * and never hold on to a time series themselves, so it is up to the sink how much of the history is kept.
+	 */
+	class Sink {
+	public:
+		virtual ~Sink() = default;
+
+		virtual void push(Type type, double_t value) = 0;
+	};
+
+	/**
+	 * Keeps the complete time series of every observable.
+	 */
+	class Series final : public Sink {
+	public:
+		/**
+		 * @param sweeps The expected length of every time series, which is reserved up front
+		 */
+		explicit Series(std::size_t sweeps = 0);
+
+		void push(Type type, double_t value) override;
+
+		[[nodiscard]] const std::unordered_map<Type, std::vector<double_t>> & values() const noexcept;
+
+		/**
+		 * Hands out the time series and leaves the sink empty.
+		 */
+		[[nodiscard]] std::unordered_map<Type, std::vector<double_t>> release() noexcept;
+
+	private:
+		std::size_t sweeps;
+		std::unordered_map<Type, std::vector<double_t>> series;
+	};
+
+	/**
+	 * Keeps the running mean and variance of every observable, updated with Welford's algorithm.
+	 */
+	class Moments final : public Sink {
+	public:
+		void push(Type type, double_t value) override;
+
+		/**
+		 * @return The observables pushed so far.
+		 */
+		[[nodiscard]] std::vector<Type> types() const;
+
+		[[nodiscard]] std::size_t count(Type type) const;
+		[[nodiscard]] double_t mean(Type type) const;
+		[[nodiscard]] double_t variance(Type type) const;
+
+	private:
+		struct Moment {
+			std::size_t count = 0;
+			double_t mean = 0.0;
+
+			/// The sum of the squared deviations from the current mean
+			double_t m2 = 0.0;
+		};
+
+		std::map<Type, Moment> moments;
+	};
+
+	/**
+	 * Averages the time series of every observable into at most a fixed number of blocks. Once all blocks are filled,
+	 * neighbouring blocks are merged, which halves their number and doubles the number of sweeps per block, so the
+	 * memory stays bounded however long the series grows.
+	 */
+	class Blocking final : public Sink {
+	public:
+		/**
+		 * @param capacity The maximum number of blocks per observable, which must be even
+		 */
+		explicit Blocking(std::size_t capacity);
+
+		void push(Type type, double_t value) override;
+
+		/**
+		 * Merges consecutive blocks into blocks of at least the given number of sweeps. The last block holds whatever
+		 * remains, just as the blocks of a complete time series do.
+		 *
+		 * @param type The observable
+		 * @param stride The minimum number of sweeps per block, usually the integrated autocorrelation time
+		 * @return The mean of every block.
+		 */
+		[[nodiscard]] std::vector<double_t> reblock(Type type, std::size_t stride) const;
+
+		/**
+		 * @return The observables pushed so far.
+		 */
+		[[nodiscard]] std::vector<Type> types() const;
+
+	private:
+		struct Blocks {
+			/// The sum of the values of every completed block
+			std::vector<double_t> sums;
+
+			/// The number of sweeps per completed block
+			std::size_t size = 1;
+
+			/// The sum and the number of the values of the block currently being filled
+			double_t pending = 0.0;
+			std::size_t pending_count = 0;
+		};
+
+		std::size_t capacity;
+		std::map<Type, Blocks> blocks;
+	};
+
+	/**
+	 * Keeps the most recent values of every observable in a ring buffer of fixed capacity, enough to estimate the
+	 * autocorrelation function over a bounded window.
+	 */
+	class RingBuffer final : public Sink {
+	public:
+		explicit RingBuffer(std::size_t capacity);
+
+		void push(Type type, double_t value) override;
+
+		/**
+		 * @return The buffered values of the observable from the oldest to the most recent one.
+		 */
+		[[nodiscard]] std::vector<double_t> values(Type type) const;
+
+	private:
+		struct Buffer {
+			std::vector<double_t> values;
+
+			/// The slot the next value is written to once the buffer is full
+			std::size_t next = 0;
+		};
+
+		std::size_t capacity;
+		std::map<Type, Buffer> buffers;
+	};
+
+	/**
+	 * Correlates the time series of every observable on the fly with a multi-tau correlator. The first level correlates
+	 * the raw values at lags 0 to channels - 1. Every further level works on the averages of pairs of values of the
+	 * previous one and covers the lags channels / 2 to channels - 1 in units of its doubled time step, so the lags grow
+	 * logarithmically and a series of n values needs only O(channels * log n) memory and O(channels) work per value.
+	 */
+	class Correlator final : public Sink {
+	public:
+		/**
+		 * @param channels The number of lags per level, which must be even
+		 */
+		explicit Correlator(std::size_t channels = 16);
+
+		void push(Type type, double_t value) override;
+
+		/**
+		 * @return The lags in sweeps and the normalized autocorrelation function at each of them, starting at lag zero.
+		 */
+		[[nodiscard]] std::vector<std::tuple<std::size_t, double_t>> autocorrelation(Type type) const;
+
+	private:
+		struct Level {
+			/// The most recent values of the level, the latest one at head
+			std::vector<double_t> values;
+			std::size_t head = 0, inserted = 0;
+
+			/// The sum of the products and the number of products at every lag
+			std::vector<double_t> products;
+			std::vector<std::size_t> counts;
+
+			/// The sum of the values waiting to be averaged into the next level
+			double_t pending = 0.0;
+			std::size_t pending_count = 0;
+		};
+
+		struct Correlation {
+			std::vector<Level> levels;
+
+			/// The values are correlated relative to the first one, which keeps the products small
+			double_t shift = 0.0;
+			double_t sum = 0.0;
+			std::size_t count = 0;
+		};
+
+		void insert(Correlation & correlation, std::size_t level, double_t value) const;
+
+		std::size_t channels;
+		std::map<Type, Correlation> correlations;
+	};
+}
+
+#endif //SINK_HPP
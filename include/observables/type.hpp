@@ -4,6 +4,7 @@
 #include <cmath>
 #include <ostream>
 #include <map>
+#include <optional>
 #include <vector>
 
 namespace observables {
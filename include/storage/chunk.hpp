@@ -21,6 +21,9 @@ struct Chunk final {
 
 	std::optional<std::vector<double_t>> spins;
 
+	/// The width of the Metropolis proposal window tuned by a previous chunk of the same configuration
+	std::optional<double_t> proposal_width;
+
 	[[nodiscard]] bool first() const {
 		return index == 1;
 	}
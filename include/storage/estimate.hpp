@@ -1,6 +1,7 @@
 #ifndef ESTIMATE_HPP
 #define ESTIMATE_HPP
 
+#include "analysis/boostrap.hpp"
 #include "observables/type.hpp"
 
 struct Estimate {
@@ -9,6 +10,25 @@ struct Estimate {
 	const observables::Type type;
 
 	const std::size_t bootstrap_resamples;
+
+	const double_t bootstrap_tolerance;
+
+	const analysis::ErrorEstimator error_estimator;
+};
+
+/**
+ * All observables of a configuration which are bootstrapped together.
+ */
+struct JointEstimate {
+	const int configuration_id;
+
+	const double_t temperature;
+
+	const std::size_t bootstrap_resamples;
+
+	const double_t bootstrap_tolerance;
+
+	const analysis::ErrorEstimator error_estimator;
 };
 
 #endif //ESTIMATE_HPP
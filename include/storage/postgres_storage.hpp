@@ -17,13 +17,21 @@ public:
 
 	std::optional<Chunk> next_chunk(int simulation_id) override;
 
-	void save_chunk(const Chunk & chunk, int32_t thread_num, int64_t start_time, int64_t end_time, const std::span<const uint8_t> & spins, const std::map<observables::Type, std::tuple<double_t, std::vector<uint8_t>, std::optional<std::vector<uint8_t>>>> & results) override;
+	std::vector<Chunk> next_siblings(const Chunk & chunk, std::size_t count) override;
+
+	std::optional<std::tuple<std::size_t, std::vector<Chunk>>> next_replicas(int simulation_id) override;
+
+	void save_chunk(const Chunk & chunk, int32_t thread_num, int64_t start_time, int64_t end_time, const std::span<const uint8_t> & spins, const std::optional<std::tuple<double_t, double_t>> & proposal, const std::map<observables::Type, std::tuple<double_t, std::vector<uint8_t>, std::optional<std::vector<uint8_t>>>> & results) override;
 
 	std::optional<std::tuple<Estimate, std::vector<double_t>>> next_estimate(int simulation_id) override;
 
 	std::optional<NextDerivative> next_derivative(int simulation_id) override;
 
-	void save_estimate(int configuration_id, int32_t thread_num, int64_t start_time, int64_t end_time, observables::Type type, double_t mean, double_t std_dev) override;
+	void save_estimate(int configuration_id, int32_t thread_num, int64_t start_time, int64_t end_time, observables::Type type, double_t mean, double_t std_dev, std::optional<std::size_t> block_size, std::optional<std::size_t> resamples) override;
+
+	std::optional<std::tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>>> next_joint_estimate(int simulation_id) override;
+
+	void save_estimates(int configuration_id, int32_t thread_num, int64_t start_time, int64_t end_time, const analysis::Estimates & estimates) override;
 
 	void worker_keep_alive() override;
 
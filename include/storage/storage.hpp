@@ -19,11 +19,45 @@ public:
 
 	virtual std::optional<Chunk> next_chunk(int simulation_id) = 0;
 
-	virtual void save_chunk(const Chunk & chunk, int32_t thread_num, int64_t start_time, int64_t end_time, const std::span<const uint8_t> & spins, const std::map<observables::Type, std::tuple<double_t, std::vector<uint8_t>, std::optional<std::vector<uint8_t>>>> & results) = 0;
+	/**
+	 * Claims the next chunk of up to count other configurations with the same metadata and lattice size as the given
+	 * chunk, so all of them can be simulated together in a single batch.
+	 *
+	 * @return The claimed chunks, which may be fewer than requested or none at all.
+	 */
+	virtual std::vector<Chunk> next_siblings(const Chunk & chunk, std::size_t count) = 0;
+
+	/**
+	 * Claims the next chunk of every temperature of one lattice size which is simulated with replica exchange.
+	 *
+	 * @return The number of sweeps between two exchanges and the chunks ordered by temperature.
+	 */
+	virtual std::optional<std::tuple<std::size_t, std::vector<Chunk>>> next_replicas(int simulation_id) = 0;
+
+	virtual void save_chunk(const Chunk & chunk, int32_t thread_num, int64_t start_time, int64_t end_time, const std::span<const uint8_t> & spins, const std::optional<std::tuple<double_t, double_t>> & proposal, const std::map<observables::Type, std::tuple<double_t, std::vector<uint8_t>, std::optional<std::vector<uint8_t>>>> & results) = 0;
 
 	virtual std::optional<std::tuple<Estimate, std::vector<double_t>>> next_estimate(int simulation_id) = 0;
 
-	virtual void save_estimate(int configuration_id, int32_t thread_num, int64_t start_time, int64_t end_time, observables::Type type, double_t mean, double_t std_dev) = 0;
+	/**
+	 * Saves the estimate of one observable of a configuration.
+	 *
+	 * @param block_size The number of blocks per bin the estimator chose, if it chose one
+	 * @param resamples The number of resamples the estimator drew, if it drew any
+	 */
+	virtual void save_estimate(int configuration_id, int32_t thread_num, int64_t start_time, int64_t end_time, observables::Type type, double_t mean, double_t std_dev, std::optional<std::size_t> block_size, std::optional<std::size_t> resamples) = 0;
+
+	/**
+	 * Claims the next completed configuration which is missing any of its estimates and loads the results of all of
+	 * its observables at once.
+	 *
+	 * @return The configuration and the blocked time series of every observable.
+	 */
+	virtual std::optional<std::tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>>> next_joint_estimate(int simulation_id) = 0;
+
+	/**
+	 * Saves the estimates of all observables of a configuration in one transaction, replacing any estimate saved before.
+	 */
+	virtual void save_estimates(int configuration_id, int32_t thread_num, int64_t start_time, int64_t end_time, const analysis::Estimates & estimates) = 0;
 
 	virtual std::optional<NextDerivative> next_derivative(int simulation_id) = 0;
 
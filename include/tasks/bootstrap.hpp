@@ -1,15 +1,18 @@
 #ifndef BOOTSTRAP_HPP
 #define BOOTSTRAP_HPP
 
+#include <tbb/task_arena.h>
+
 #include "task.hpp"
+#include "analysis/jackknife.hpp"
 #include "storage/storage.hpp"
 
 namespace tasks {
 	template<typename TStorage> requires std::is_base_of_v<Storage, TStorage>
-	class Bootstrap final : public Task<TStorage, std::tuple<Estimate, std::vector<double_t>>, std::tuple<double_t, double_t>> {
+	class Bootstrap final : public Task<TStorage, std::tuple<Estimate, std::vector<double_t>>, std::tuple<double_t, double_t, std::optional<std::size_t>, std::optional<std::size_t>>> {
 	public:
 		template<typename ... Args>
-		explicit Bootstrap(const Config & config, Args && ... args) : Task<TStorage, std::tuple<Estimate, std::vector<double_t>>, std::tuple<double_t, double_t>>(config, std::forward<Args>(args)...) {
+		explicit Bootstrap(const Config & config, Args && ... args) : Task<TStorage, std::tuple<Estimate, std::vector<double_t>>, std::tuple<double_t, double_t, std::optional<std::size_t>, std::optional<std::size_t>>>(config, std::forward<Args>(args)...) {
 
 		}
 
@@ -18,19 +21,32 @@ namespace tasks {
 			return storage->next_estimate(this->config.simulation_id);
 		}
 
-		std::tuple<double_t, double_t> execute_task(const std::tuple<Estimate, std::vector<double_t>> & task) override {
+		std::tuple<double_t, double_t, std::optional<std::size_t>, std::optional<std::size_t>> execute_task(const std::tuple<Estimate, std::vector<double_t>> & task) override {
 			XoshiroCpp::Xoshiro256Plus rng { std::random_device {}() };
 
 			const auto [estimate, values] = task;
-			return analysis::bootstrap_blocked(rng, values, estimate.bootstrap_resamples);
+
+			// The jackknife is linear in the number of blocks and needs no further threads. A single block leaves no
+			// jackknife sample, so such a series falls back to the bootstrap instead of terminating the worker.
+			if (estimate.error_estimator == analysis::JACKKNIFE && values.size() >= 2) {
+				const auto [mean, std_dev, block_size] = analysis::jackknife_binned(values);
+				return { mean, std_dev, block_size, std::nullopt };
+			}
+
+			// The resamples are spread over the threads of idle workers once no other estimates are waiting
+			const auto threads = this->lend_threads();
+			std::tuple<double_t, double_t, std::size_t> result;
+			tbb::task_arena arena { static_cast<int>(threads.count()) };
+			arena.execute([&] { result = analysis::bootstrap_blocked(rng, values, estimate.bootstrap_resamples, estimate.bootstrap_tolerance); });
+			return { get<0>(result), get<1>(result), std::nullopt, get<2>(result) };
 		}
 
-		void save_task(std::shared_ptr<TStorage> storage, const std::tuple<Estimate, std::vector<double_t>> & task, int32_t thread_num, int64_t start_time, int64_t end_time, const std::tuple<double_t, double_t> & result) override {
+		void save_task(std::shared_ptr<TStorage> storage, const std::tuple<Estimate, std::vector<double_t>> & task, int32_t thread_num, int64_t start_time, int64_t end_time, const std::tuple<double_t, double_t, std::optional<std::size_t>, std::optional<std::size_t>> & result) override {
 			const auto [estimate, _1] = task;
-			const auto [mean, std_dev] = result;
+			const auto [mean, std_dev, block_size, resamples] = result;
 
 			std::cout << "[Bootstrap] ConfigurationId: " << estimate.configuration_id << " | Type: " << estimate.type << std::endl;
-			storage->save_estimate(estimate.configuration_id, thread_num, start_time, end_time, estimate.type, mean, std_dev);
+			storage->save_estimate(estimate.configuration_id, thread_num, start_time, end_time, estimate.type, mean, std_dev, block_size, resamples);
 		}
 	};
 }
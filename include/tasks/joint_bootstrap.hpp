@@ -0,0 +1,54 @@
+#ifndef JOINT_BOOTSTRAP_HPP
+#define JOINT_BOOTSTRAP_HPP
+
+#include <algorithm>
+#include <tbb/task_arena.h>
+
+#include "task.hpp"
+#include "analysis/jackknife.hpp"
+#include "storage/storage.hpp"
+
+namespace tasks {
+	template<typename TStorage> requires std::is_base_of_v<Storage, TStorage>
+	class JointBootstrap final : public Task<TStorage, std::tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>>, analysis::Estimates> {
+	public:
+		template<typename ... Args>
+		explicit JointBootstrap(const Config & config, Args && ... args) : Task<TStorage, std::tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>>, analysis::Estimates>(config, std::forward<Args>(args)...) {
+
+		}
+
+	protected:
+		std::optional<std::tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>>> next_task(std::shared_ptr<TStorage> storage) override {
+			return storage->next_joint_estimate(this->config.simulation_id);
+		}
+
+		analysis::Estimates execute_task(const std::tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>> & task) override {
+			XoshiroCpp::Xoshiro256Plus rng { std::random_device {}() };
+
+			const auto & [estimate, values] = task;
+
+			// The jackknife is linear in the number of blocks and needs no further threads. A single block leaves no
+			// jackknife sample, so such a configuration falls back to the bootstrap instead of terminating the worker.
+			const auto enough_blocks = std::ranges::all_of(values, [] (const auto & series) { return series.second.size() >= 2; });
+			if (estimate.error_estimator == analysis::JACKKNIFE && enough_blocks) {
+				return analysis::jackknife_joint(values, estimate.temperature);
+			}
+
+			// The resamples are spread over the threads of idle workers once no other configurations are waiting
+			const auto threads = this->lend_threads();
+			analysis::Estimates result;
+			tbb::task_arena arena { static_cast<int>(threads.count()) };
+			arena.execute([&] { result = analysis::bootstrap_joint(rng, values, estimate.temperature, estimate.bootstrap_resamples, estimate.bootstrap_tolerance); });
+			return result;
+		}
+
+		void save_task(std::shared_ptr<TStorage> storage, const std::tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>> & task, int32_t thread_num, int64_t start_time, int64_t end_time, const analysis::Estimates & result) override {
+			const auto & [estimate, _1] = task;
+
+			std::cout << "[JointBootstrap] ConfigurationId: " << estimate.configuration_id << " | Types: " << result.size() << std::endl;
+			storage->save_estimates(estimate.configuration_id, thread_num, start_time, end_time, result);
+		}
+	};
+}
+
+#endif //JOINT_BOOTSTRAP_HPP
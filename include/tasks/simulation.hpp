@@ -1,50 +1,195 @@
 #ifndef SIMULATION_HPP
 #define SIMULATION_HPP
 
+#include <ranges>
+
+#include "observables/sink.hpp"
 #include "observables/type.hpp"
 #include "analysis/autocorrelation.hpp"
 #include "analysis/boostrap.hpp"
+#include "algorithms/simulator.hpp"
 #include "tasks/task.hpp"
 #include "schemas/serialize.hpp"
 
 namespace tasks {
+	/// The final spins, the analysed observables and the proposal window with its acceptance rate of a chunk
+	using ChunkResult = std::tuple<std::vector<double_t>, observables::Map, std::optional<std::tuple<double_t, double_t>>>;
+
+	/**
+	 * The measurements of a chunk. The first chunk of a configuration keeps its complete time series, which it needs to
+	 * be thermalized. All later chunks only stream their measurements into bounded blocks, so their memory stays bounded
+	 * however many sweeps a chunk has. The autocorrelation is either estimated by a multi-tau correlator during the
+	 * sweeps or afterwards by the FFT of the complete series, respectively of its most recent sweeps.
+	 */
+	class Recording final : public observables::Sink {
+	public:
+		Recording(const Chunk & chunk, const Config & config) : first(chunk.first()) {
+			if (first) series.emplace(chunk.sweeps);
+			else blocking.emplace(config.max_blocks);
+
+			if (config.autocorrelation == analysis::MULTI_TAU) {
+				correlator.emplace();
+			} else if (!first) {
+				moments.emplace();
+				window.emplace(config.autocorrelation_window);
+			}
+		}
+
+		void push(const observables::Type type, const double_t value) override {
+			if (series) series->push(type, value);
+			if (moments) moments->push(type, value);
+			if (blocking) blocking->push(type, value);
+			if (window) window->push(type, value);
+			if (correlator) correlator->push(type, value);
+		}
+
+		/**
+		 * Estimates the autocorrelation time of every observable and blocks the measurements accordingly. Only the
+		 * first chunk of a configuration is thermalized and keeps its autocorrelation function.
+		 */
+		[[nodiscard]] observables::Map analyse() const {
+			std::vector<observables::Type> types;
+			if (series) for (const auto & type : series->values() | std::views::keys) types.push_back(type);
+			else types = blocking->types();
+
+			observables::Map results;
+			for (const auto type : types) {
+				const auto [tau, autocorrelation] = correlator ? analysis::integrated_autocorrelation_time(correlator->autocorrelation(type))
+					: series ? analysis::integrated_autocorrelation_time(series->values().at(type))
+					: analysis::integrated_autocorrelation_time(window->values(type), moments->mean(type));
+
+				auto blocked = series ? analysis::thermalize_and_block(series->values().at(type), tau, !first) : blocking->reblock(type, static_cast<std::size_t>(std::ceil(tau)));
+				results[type] = { tau, std::move(blocked), first ? std::make_optional(autocorrelation) : std::nullopt };
+			}
+			return results;
+		}
+
+		/**
+		 * @return The sinks of all recordings, one per chunk.
+		 */
+		[[nodiscard]] static std::vector<observables::Sink *> sinks(std::vector<Recording> & recordings) {
+			std::vector<observables::Sink *> result;
+			for (auto & recording : recordings) result.push_back(&recording);
+			return result;
+		}
+
+	private:
+		bool first;
+		std::optional<observables::Series> series;
+		std::optional<observables::Moments> moments;
+		std::optional<observables::Blocking> blocking;
+		std::optional<observables::RingBuffer> window;
+		std::optional<observables::Correlator> correlator;
+	};
+
+	/**
+	 * Analyses the measurements of a chunk and collects everything which is saved along with them.
+	 */
+	inline ChunkResult analyse_chunk(const Chunk & chunk, const Recording & recording, std::vector<double_t> spins, const algorithms::ProposalWindow & window) {
+		// Only Metropolis proposes within a window, which later chunks of the same configuration continue with
+		std::optional<std::tuple<double_t, double_t>> proposal = std::nullopt;
+		if (chunk.algorithm == algorithms::METROPOLIS) {
+			proposal = { window.width, window.acceptance };
+		}
+		return { std::move(spins), recording.analyse(), proposal };
+	}
+
+	inline ChunkResult analyse_chunk(const Chunk & chunk, const Recording & recording, const algorithms::Simulator & simulator) {
+		return analyse_chunk(chunk, recording, simulator.get_spins(), simulator.get_proposal_window());
+	}
+
+	/**
+	 * Serializes the result of a chunk and saves it to the storage.
+	 */
+	template<typename TStorage> requires std::is_base_of_v<Storage, TStorage>
+	void save_chunk_result(std::shared_ptr<TStorage> storage, const Chunk & chunk, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const ChunkResult & result) {
+		const auto [ spin_data, measurements, proposal ] = result;
+		const auto spins = schemas::serialize(spin_data);
+
+		std::map<observables::Type, std::tuple<double_t, std::vector<uint8_t>, std::optional<std::vector<uint8_t>>>> results;
+		for (const auto & [ type, value ] : measurements) {
+			const auto [tau, values, autocorrelation] = value;
+			results.insert({ type, { tau, schemas::serialize(values), autocorrelation.transform(schemas::serialize) } });
+		}
+
+		std::cout << "[Simulation] " << chunk.algorithm << " | Size: " << chunk.lattice_size << " | ConfigurationId: " << chunk.configuration_id << " | Index: " << chunk.index;
+		if (proposal) std::cout << " | Width: " << get<0>(*proposal) << " | Acceptance: " << get<1>(*proposal);
+		std::cout << std::endl;
+		storage->save_chunk(chunk, thread_num, start_time, end_time, spins, proposal, results);
+	}
+
+	/**
+	 * Simulates the next chunk of a configuration. With batching enabled the chunks of further configurations with the
+	 * same lattice size are claimed along with it and simulated together, one replica per SIMD lane.
+	 */
 	template<typename TStorage> requires std::is_base_of_v<Storage, TStorage>
-	class Simulation final : public Task<TStorage, Chunk, std::tuple<std::vector<double_t>, observables::Map>> {
+	class Simulation final : public Task<TStorage, std::vector<Chunk>, std::vector<ChunkResult>> {
 	public:
 		template<typename ... Args>
-		explicit Simulation(const Config & config, Args && ... args) : Task<TStorage, Chunk, std::tuple<std::vector<double_t>, observables::Map>>(config, std::forward<Args>(args)...) {
+		explicit Simulation(const Config & config, Args && ... args) : Task<TStorage, std::vector<Chunk>, std::vector<ChunkResult>>(config, std::forward<Args>(args)...) {
 
 		}
 
 	protected:
-		std::optional<Chunk> next_task(std::shared_ptr<TStorage> storage) override {
-			return storage->next_chunk(this->config.simulation_id);
+		std::optional<std::vector<Chunk>> next_task(std::shared_ptr<TStorage> storage) override {
+			const auto chunk = storage->next_chunk(this->config.simulation_id);
+			if (!chunk) return std::nullopt;
+
+			std::vector chunks { *chunk };
+			if (algorithms::supports_batch(chunk->algorithm, this->config.options(chunk->algorithm))) {
+				for (const auto & sibling : storage->next_siblings(*chunk, algorithms::batch_width() - 1)) {
+					chunks.push_back(sibling);
+				}
+			}
+			return chunks;
 		}
 
-		std::tuple<std::vector<double_t>, observables::Map> execute_task(const Chunk & chunk) override {
+		std::vector<ChunkResult> execute_task(const std::vector<Chunk> & chunks) override {
 			XoshiroCpp::Xoshiro256Plus rng { std::random_device {}() };
-			Lattice lattice {chunk.lattice_size, 1.0 / chunk.temperature, chunk.spins};
+			const auto & first = chunks.front();
+			auto options = this->config.options(first.algorithm);
 
-			observables::Map results;
-			for (auto [type, values] : algorithms::simulate(lattice, rng, chunk.sweeps, chunk.algorithm)) {
-				const auto[tau, autocorrelation] = analysis::integrated_autocorrelation_time(values);
-				results[type] = { tau, analysis::thermalize_and_block(values, tau, !chunk.first()), chunk.first() ? std::make_optional(autocorrelation) : std::nullopt };
+			if (algorithms::supports_batch(first.algorithm, options)) {
+				std::vector<double_t> betas;
+				std::vector<std::optional<std::vector<double_t>>> spins;
+				for (const auto & chunk : chunks) {
+					betas.push_back(1.0 / chunk.temperature);
+					spins.push_back(chunk.spins);
+				}
+
+				std::vector<Recording> recordings;
+				for (const auto & chunk : chunks) recordings.emplace_back(chunk, this->config);
+
+				const auto simulator = algorithms::make_batch_simulator(first.lattice_size, betas, spins, options);
+				auto sinks = Recording::sinks(recordings);
+				simulator->simulate(rng, first.sweeps, sinks);
+
+				std::vector<ChunkResult> results;
+				for (std::size_t i = 0; i < chunks.size(); ++i) {
+					results.push_back(analyse_chunk(chunks[i], recordings[i], simulator->get_spins(i), simulator->get_proposal_window(i)));
+				}
+				return results;
 			}
-			return { lattice.get_spins(), results };
-		}
 
-		void save_task(std::shared_ptr<TStorage> storage, const Chunk & chunk, int32_t thread_num, int64_t start_time, int64_t end_time, const std::tuple<std::vector<double_t>, observables::Map> & result) override {
-			const auto [ spin_data, measurements ] = result;
-			const auto spins = schemas::serialize(spin_data);
+			Recording recording { first, this->config };
+			std::unique_ptr<algorithms::Simulator> simulator;
+			{
+				// A chunk may update its lattice on the threads of idle workers once no other chunks are waiting, as long
+				// as its algorithm makes use of them
+				const auto threads = this->lend_threads(algorithms::supports_threads(first.algorithm));
+				options.threads = threads.count();
 
-			std::map<observables::Type, std::tuple<double_t, std::vector<uint8_t>, std::optional<std::vector<uint8_t>>>> results;
-			for (const auto & [ type, value ] : measurements) {
-				const auto [tau, values, autocorrelation] = value;
-				results.insert({ type, { tau, schemas::serialize(values), autocorrelation.transform(schemas::serialize) } });
+				simulator = algorithms::make_simulator(first.lattice_size, 1.0 / first.temperature, first.spins, options);
+				if (first.proposal_width) simulator->set_proposal_width(*first.proposal_width);
+				simulator->simulate(rng, first.sweeps, first.algorithm, recording);
 			}
+			return { analyse_chunk(first, recording, *simulator) };
+		}
 
-			std::cout << "[Simulation] " << chunk.algorithm << " | Size: " << chunk.lattice_size << " | ConfigurationId: " << chunk.configuration_id << " | Index: " << chunk.index << std::endl;
-			storage->save_chunk(chunk, thread_num, start_time, end_time, spins, results);
+		void save_task(std::shared_ptr<TStorage> storage, const std::vector<Chunk> & chunks, int32_t thread_num, int64_t start_time, int64_t end_time, const std::vector<ChunkResult> & result) override {
+			for (std::size_t i = 0; i < chunks.size(); ++i) {
+				save_chunk_result(storage, chunks[i], thread_num, start_time, end_time, result[i]);
+			}
 		}
 	};
 }
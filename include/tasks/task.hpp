@@ -4,11 +4,13 @@
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <thread>
 #include <queue>
 #include <optional>
 #include <utility>
+#include <tbb/concurrent_queue.h>
 
 #include "storage/storage.hpp"
 #include "utils/utils.hpp"
@@ -28,69 +30,54 @@ namespace tasks {
 			std::cout << "[Task] Staggering the start..." << std::endl;
 			utils::sleep_between(0, 1000);
 
-			// Keeping track of worker threads
-			std::vector<std::thread> workers;
-			std::unique_lock lock_tasks { available_tasks_mutex };
-
-			// Create worker threads and fetch initial tasks
-			for (std::size_t i = 0; i < std::thread::hardware_concurrency(); ++i) {
-				if (const auto task = next_task(this->storage)) {
-					available_tasks.push(*task);
-				}
+			// Fetch the initial tasks before starting any worker
+			if (!refill()) {
+				return;
+			}
 
-				if (i == 0 && available_tasks.empty()) {
-					return;
-				}
+			// Create worker threads, which start on the queued tasks right away
+			std::vector<std::thread> workers;
+			for (std::size_t i = 0; i < concurrency; ++i) {
 				workers.emplace_back(&Task::execute_worker, this);
 			}
 
-			// Start workers
-			lock_tasks.unlock();
-			available_tasks_signal.notify_all();
-
-			// Wait for results
-			auto last_keep_alive = std::chrono::system_clock::now();
-			while (!exit_flag) {
-				std::unique_lock lock { available_results_signal_mutex };
-				available_results_signal.wait_for(lock, std::chrono::seconds(1), [&] {
-					const std::unique_lock result_lock { available_results_mutex };
+			// Wait for the workers handing in results and only wake up on a timeout for the keep alive
+			auto next_keep_alive = std::chrono::steady_clock::now() + KEEP_ALIVE_INTERVAL;
+			std::unique_lock lock { events_mutex };
+			while (true) {
+				events_signal.wait_until(lock, next_keep_alive, [&] {
 					return !available_results.empty();
 				});
+
+				auto results = std::exchange(available_results, {});
+				outstanding_tasks -= results.size();
 				lock.unlock();
 
-				// Save the complete queue
-				save_queue(available_results, available_results_mutex);
+				// Save the results, which may free further tasks in the storage, and replace the finished tasks
+				save_queue(results);
+				refill();
 
 				// Send a keep alive message every 10 seconds
-				if (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() - last_keep_alive).count() >= 10) {
-					last_keep_alive = std::chrono::system_clock::now();
+				if (std::chrono::steady_clock::now() >= next_keep_alive) {
+					next_keep_alive = std::chrono::steady_clock::now() + KEEP_ALIVE_INTERVAL;
 					this->storage->worker_keep_alive();
 				}
 
-				// Fill missing tasks
-				lock_tasks.lock();
-				for (std::size_t i = 0; i < idle_workers; ++i) {
-					if (const auto task = next_task(this->storage)) {
-						available_tasks.push(*task);
-					}
+				// Done once the storage has no tasks left and the result of every task handed out has been saved
+				if (drained && outstanding_tasks == 0) {
+					break;
 				}
+				lock.lock();
+			}
 
-				const auto empty = available_tasks.empty();
-				lock_tasks.unlock();
-
-				available_tasks_signal.notify_all();
-				if (idle_workers == std::thread::hardware_concurrency() && empty) {
-					exit_flag = true;
-				}
+			// Release the workers, which are all waiting for a task by now
+			for (std::size_t i = 0; i < concurrency; ++i) {
+				available_tasks.push(std::nullopt);
 			}
 
-			// Wait for all workers to finish
 			for (auto & worker : workers) {
 				worker.join();
 			}
-
-			// Save the complete queue
-			save_queue(available_results, available_results_mutex);
 		}
 
 	protected:
@@ -102,82 +89,153 @@ namespace tasks {
 
 		virtual void save_task(std::shared_ptr<TStorage> storage, const TTask & task, int32_t thread_num, int64_t start_time, int64_t end_time, const TResult & result) = 0;
 
+		/**
+		 * The threads of idle workers lent to a running task, which are returned once the guard goes out of scope, also
+		 * when the task throws.
+		 */
+		class LentThreads {
+		public:
+			LentThreads(Task & task, const bool claim) : task(task), threads(claim ? task.claim_threads() : 1) {
+
+			}
+
+			~LentThreads() {
+				task.release_threads(threads);
+			}
+
+			LentThreads(const LentThreads &) = delete;
+			LentThreads & operator=(const LentThreads &) = delete;
+
+			/**
+			 * @return The number of threads the task may use, including its own.
+			 */
+			[[nodiscard]] std::size_t count() const noexcept {
+				return threads;
+			}
+
+		private:
+			Task & task;
+			const std::size_t threads;
+		};
+
+		/**
+		 * Lends the threads of idle workers to the calling task once the storage has no tasks left for them, so the last
+		 * few tasks of a phase do not leave most cores idle. Every lent thread is only handed out once and is returned
+		 * when the guard is destroyed.
+		 *
+		 * @param claim Whether the task makes use of further threads at all, otherwise the guard only holds its own
+		 */
+		[[nodiscard]] LentThreads lend_threads(const bool claim = true) {
+			return LentThreads { *this, claim };
+		}
+
 	private:
+		/**
+		 * @return The number of threads the calling task may use, including its own.
+		 */
+		std::size_t claim_threads() {
+			if (!drained || !available_tasks.empty()) return 1;
+
+			const std::size_t busy = busy_workers;
+			const auto idle = concurrency > busy ? concurrency - busy : 0;
+
+			// Several tasks may claim at once, so the spare threads are taken with a compare and swap
+			auto lent = lent_threads.load();
+			std::size_t spare;
+			do {
+				spare = idle > lent ? idle - lent : 0;
+			} while (!lent_threads.compare_exchange_weak(lent, lent + static_cast<unsigned>(spare)));
+			return 1 + spare;
+		}
+
+		void release_threads(const std::size_t count) {
+			lent_threads -= count - 1;
+		}
+
+		/// The number of tasks fetched ahead of the workers, so a worker finishing its task starts on the next one
+		/// without waiting for the main loop to save its result and fetch a new task from the storage
+		static constexpr std::size_t PREFETCHED_TASKS = 1;
+
+		static constexpr std::chrono::seconds KEEP_ALIVE_INTERVAL { 10 };
+
 		/// A counter to keep track of how many results have been saved to storage.
 		std::size_t counter { 0 };
 
 		std::atomic_int threads { 0 };
 
+		/// The number of worker threads
+		const std::size_t concurrency { std::thread::hardware_concurrency() };
+
 		/// The underlying storage engine for this task.
 		std::shared_ptr<TStorage> storage;
 
-		std::atomic_bool exit_flag;
-
-		std::atomic_uint idle_workers;
+		/// The number of workers currently executing a task
+		std::atomic_size_t busy_workers { 0 };
 
-		std::mutex available_tasks_mutex;
+		/// Whether the storage had no task left when it was asked last
+		std::atomic_bool drained { false };
 
-		std::queue<TTask> available_tasks;
+		/// The number of threads of idle workers currently lent to running tasks
+		std::atomic_uint lent_threads { 0 };
 
-		std::mutex available_tasks_signal_mutex;
+		/// The tasks waiting for a worker, which blocks on the queue until one arrives. An empty task stops the worker.
+		tbb::concurrent_bounded_queue<std::optional<TTask>> available_tasks;
 
-		std::condition_variable available_tasks_signal;
+		/// Guards the results, which wake up the main loop through the signal
+		std::mutex events_mutex;
 
-		std::mutex available_results_mutex;
+		std::condition_variable events_signal;
 
 		std::queue<std::tuple<TTask, int32_t, int64_t, int64_t, TResult>> available_results;
 
-		std::mutex available_results_signal_mutex;
-
-		std::condition_variable available_results_signal;
+		/// The number of tasks handed to the workers whose results have not been saved yet, only used by the main loop
+		std::size_t outstanding_tasks { 0 };
+
+		/**
+		 * Fetches tasks from the storage until every worker and PREFETCHED_TASKS more have one to work on. Only the main
+		 * loop talks to the storage.
+		 *
+		 * @return Whether any task is waiting for a worker or still running.
+		 */
+		bool refill() {
+			while (outstanding_tasks < concurrency + PREFETCHED_TASKS) {
+				const auto task = next_task(this->storage);
+				drained = !task.has_value();
+				if (drained) break;
+
+				outstanding_tasks++;
+				available_tasks.push(task);
+			}
+			return outstanding_tasks > 0;
+		}
 
 		void execute_worker() {
 			const auto thread_num = threads++;
-			while (!exit_flag) {
-				// Signal that the worker is looking for a task
-				++idle_workers;
-
+			while (true) {
 				// Wait for an incoming task
-				std::unique_lock lock { available_tasks_signal_mutex };
-				available_tasks_signal.wait_for(lock, std::chrono::seconds(1), [&] {
-					const std::unique_lock tasks_lock { available_tasks_mutex };
-					return !available_tasks.empty() || exit_flag;
-				});
-				lock.unlock();
-
-				// Worker busy and exit flag handling
-				if (exit_flag) {
+				std::optional<TTask> task;
+				available_tasks.pop(task);
+				if (!task) {
 					break;
 				}
-				--idle_workers;
-
-				// Get the task from the queue
-				std::unique_lock lock_tasks { available_tasks_mutex };
-				if (available_tasks.empty()) {
-					continue;
-				}
-				const auto task = available_tasks.front();
-
-				// Remove task from queue
-				available_tasks.pop();
-				lock_tasks.unlock();
 
 				// Execute the task
+				++busy_workers;
 				const auto start_time_ms = utils::timestamp_ms();
-				const auto result = execute_task(task);
+				const auto result = execute_task(*task);
 				const auto end_time_ms = utils::timestamp_ms();
 
-				// Push to the result queue
-				std::unique_lock lock_results { available_results_mutex };
-				available_results.push({ task, thread_num, start_time_ms, end_time_ms, result });
-
-				// Signal the result is ready
-				available_results_signal.notify_one();
+				// Push to the result queue and signal the result is ready
+				{
+					const std::unique_lock lock { events_mutex };
+					available_results.push({ *task, thread_num, start_time_ms, end_time_ms, result });
+					--busy_workers;
+				}
+				events_signal.notify_one();
 			}
 		}
 
-		void save_queue(std::queue<std::tuple<TTask, int32_t, int64_t, int64_t, TResult>> & queue, std::mutex & queue_mutex) {
-			const std::unique_lock lock { queue_mutex };
+		void save_queue(std::queue<std::tuple<TTask, int32_t, int64_t, int64_t, TResult>> & queue) {
 			while (!queue.empty()) {
 				const auto [task, thread_num, start_time, end_time, result] = queue.front();
 				queue.pop();
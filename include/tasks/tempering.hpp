@@ -0,0 +1,73 @@
+#ifndef TEMPERING_HPP
+#define TEMPERING_HPP
+
+#include <tbb/task_arena.h>
+
+#include "algorithms/replica_exchange.hpp"
+#include "tasks/simulation.hpp"
+
+namespace tasks {
+	/**
+	 * Simulates the next chunk of all temperatures of one lattice size together with replica exchange. The chunks are
+	 * saved one by one exactly like the chunks of independent chains, so the analysis does not tell them apart.
+	 */
+	template<typename TStorage> requires std::is_base_of_v<Storage, TStorage>
+	class Tempering final : public Task<TStorage, std::tuple<std::size_t, std::vector<Chunk>>, std::vector<ChunkResult>> {
+	public:
+		template<typename ... Args>
+		explicit Tempering(const Config & config, Args && ... args) : Task<TStorage, std::tuple<std::size_t, std::vector<Chunk>>, std::vector<ChunkResult>>(config, std::forward<Args>(args)...) {
+
+		}
+
+	protected:
+		std::optional<std::tuple<std::size_t, std::vector<Chunk>>> next_task(std::shared_ptr<TStorage> storage) override {
+			return storage->next_replicas(this->config.simulation_id);
+		}
+
+		std::vector<ChunkResult> execute_task(const std::tuple<std::size_t, std::vector<Chunk>> & task) override {
+			const auto & [interval, chunks] = task;
+			XoshiroCpp::Xoshiro256Plus rng { std::random_device {}() };
+
+			std::vector<double_t> temperatures;
+			std::vector<std::optional<std::vector<double_t>>> spins;
+			for (const auto & chunk : chunks) {
+				temperatures.push_back(chunk.temperature);
+				spins.push_back(chunk.spins);
+			}
+
+			const auto & first = chunks.front();
+			algorithms::ReplicaExchange exchange { first.lattice_size, temperatures, spins, this->config.options(first.algorithm) };
+			for (std::size_t i = 0; i < chunks.size(); ++i) {
+				if (chunks[i].proposal_width) exchange.replica(i).set_proposal_width(*chunks[i].proposal_width);
+			}
+
+			std::vector<Recording> recordings;
+			for (const auto & chunk : chunks) recordings.emplace_back(chunk, this->config);
+
+			auto sinks = Recording::sinks(recordings);
+			{
+				// The replicas run one per thread on the threads of idle workers, otherwise one after another
+				const auto threads = this->lend_threads();
+				tbb::task_arena arena { static_cast<int>(threads.count()) };
+				arena.execute([&] { exchange.simulate(rng, first.sweeps, interval, first.algorithm, sinks); });
+			}
+
+			std::cout << "[Tempering] " << first.algorithm << " | Size: " << first.lattice_size << " | Replicas: " << chunks.size() << " | Swap acceptance: " << exchange.swap_acceptance() << std::endl;
+
+			std::vector<ChunkResult> results;
+			for (std::size_t i = 0; i < chunks.size(); ++i) {
+				results.push_back(analyse_chunk(chunks[i], recordings[i], exchange.replica(i)));
+			}
+			return results;
+		}
+
+		void save_task(std::shared_ptr<TStorage> storage, const std::tuple<std::size_t, std::vector<Chunk>> & task, int32_t thread_num, int64_t start_time, int64_t end_time, const std::vector<ChunkResult> & result) override {
+			const auto & chunks = get<1>(task);
+			for (std::size_t i = 0; i < chunks.size(); ++i) {
+				save_chunk_result(storage, chunks[i], thread_num, start_time, end_time, result[i]);
+			}
+		}
+	};
+}
+
+#endif //TEMPERING_HPP
@@ -3,6 +3,7 @@
 
 #include <cstddef>
 
+#include "algorithms/simulator.hpp"
 #include "tasks/task.hpp"
 
 namespace tasks {
@@ -24,29 +25,31 @@ namespace tasks {
 			const auto [vortex_id, algorithm, size] = pair;
 
 			std::size_t sweeps = 100000;
-			Lattice lattice { size, 1.0 / 1.5, std::nullopt };
+			const auto simulator = algorithms::make_simulator(size, 1.0 / 1.5, std::nullopt, this->config.options(algorithm));
 
-			// Thermalize
+			// Thermalize, the measurements are not needed, so a sink keeping only the moments takes them
 			std::cout << "[Vortices] Thermalizing for " << sweeps << " sweeps" << std::endl;
-			algorithms::simulate(lattice, rng, sweeps, algorithm);
+			observables::Moments discarded;
+			simulator->start(rng, algorithm);
+			simulator->advance(sweeps, discarded);
 
 			// Transition from hot to cold state
 			std::vector<std::tuple<double_t, std::size_t, std::vector<double_t>>> results;
 			for (const auto temperature : utils::sweep_temperature_rev(0.0, 1.5, 90)) {
 				std::cout << "[Vortices] Simulating at t " << std::fixed << std::setprecision(3) << temperature << std::endl;
-				lattice.set_beta(1.0 / temperature);
+				simulator->set_beta(1.0 / temperature);
 
 				// Stay at temperature
 				for (const std::size_t _ : std::views::iota(0, 20)) {
-					algorithms::simulate(lattice, rng, 1, algorithm);
-					results.emplace_back(temperature, ++sweeps, lattice.get_spins());
+					simulator->advance(1, discarded);
+					results.emplace_back(temperature, ++sweeps, simulator->get_spins());
 				}
 			}
 
 			// Wait for vortices to dissolve
 			for (const auto _ : std::views::iota(0, 1800)) {
-				algorithms::simulate(lattice, rng, 100, algorithm);
-				results.emplace_back(get<0>(results.at(results.size() - 1)), sweeps += 100, lattice.get_spins());
+				simulator->advance(100, discarded);
+				results.emplace_back(get<0>(results.at(results.size() - 1)), sweeps += 100, simulator->get_spins());
 			}
 
 			return results;
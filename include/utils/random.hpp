@@ -0,0 +1,112 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <array>
+#include <span>
+#include <XoshiroCpp.hpp>
+
+#include "utils/simd.hpp"
+#include "utils/utils.hpp"
+
+namespace utils {
+	inline namespace XY_ISA {
+		/**
+		 * Runs eight independent Xoshiro256+ streams side by side in SIMD registers and turns their output into uniformly
+		 * distributed numbers on [0, 1) in bulk. The streams are seeded from a scalar generator and are separated by one
+		 * jump() each, i.e. 2^128 draws, so they never overlap. Generating a whole register of numbers per step removes
+		 * the serial dependency chain of a single generator from the update kernels.
+		 */
+		class SimdXoshiro256Plus {
+		public:
+#if defined(__AVX512F__)
+			using state_type = simde__m512i;
+			static constexpr std::size_t registers = 1;
+#else
+			using state_type = simde__m256i;
+			static constexpr std::size_t registers = 2;
+#endif
+
+			/// Number of independent streams and therefore of uniforms generated per step
+			static constexpr std::size_t streams = 8;
+
+			/**
+			 * Seeds the streams from consecutive jumps of the given generator. The generator is advanced past all of them,
+			 * so it can seed further instances without producing overlapping streams.
+			 *
+			 * @param rng The scalar generator to seed the streams from
+			 */
+			explicit SimdXoshiro256Plus(XoshiroCpp::Xoshiro256Plus & rng) noexcept;
+
+			/**
+			 * Fills the given span with uniformly distributed doubles on [0, 1). Each double is made from the upper 52 bits
+			 * of a draw and is a multiple of 2^-52, half the resolution of XoshiroCpp::DoubleFromBits, so the values differ
+			 * from the ones of the scalar generator.
+			 *
+			 * @param out The span to fill
+			 */
+			void fill(std::span<double_t> out) noexcept;
+
+			/**
+			 * Fills the given span with uniformly distributed floats on [0, 1). Each float is made from the upper 23 bits of
+			 * a draw and is a multiple of 2^-23, half the resolution of XoshiroCpp::FloatFromBits.
+			 *
+			 * @param out The span to fill
+			 */
+			void fill(std::span<float> out) noexcept;
+
+			/**
+			 * Fills the given span with uniformly distributed integers on [0, range) using Lemire's multiply-and-shift
+			 * method on the upper 32 bits of each draw. The few draws which would favour some results over others are
+			 * rejected and drawn again, so the integers are exactly uniform.
+			 *
+			 * @param out The span to fill
+			 * @param range The number of possible values, which must be positive
+			 */
+			void bounded(std::span<std::uint32_t> out, std::uint32_t range) noexcept;
+
+			/**
+			 * Generates the given number of uniforms into a buffer owned by the generator. The buffer is 64-byte aligned
+			 * and only grows, so the kernels can request a whole sweep worth of numbers without allocating each time. The
+			 * returned span is invalidated by the next call for the same type.
+			 *
+			 * @tparam T The floating point type of the uniforms
+			 * @param n The number of uniforms to generate
+			 * @return A span over the generated uniforms
+			 */
+			template<typename T>
+			std::span<const T> uniforms(std::size_t n) noexcept;
+
+			/**
+			 * Returns a single uniformly distributed double on [0, 1), refilling a small internal buffer in bulk whenever
+			 * it runs empty.
+			 */
+			double_t next() noexcept {
+				if (position == buffer.size()) [[unlikely]] {
+					fill(buffer);
+					position = 0;
+				}
+				return buffer[position++];
+			}
+
+		private:
+			/// Advances all streams by one step and returns the output of each of them
+			std::array<state_type, registers> step() noexcept;
+
+			std::array<state_type, registers> s0, s1, s2, s3;
+
+			aligned_vector<double_t> doubles;
+			aligned_vector<float> floats;
+
+			alignas(64) std::array<double_t, 8 * streams> buffer;
+			std::size_t position = buffer.size();
+		};
+
+		template<>
+		std::span<const double_t> SimdXoshiro256Plus::uniforms(std::size_t n) noexcept;
+
+		template<>
+		std::span<const float> SimdXoshiro256Plus::uniforms(std::size_t n) noexcept;
+	}
+}
+
+#endif //RANDOM_HPP
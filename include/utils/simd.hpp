@@ -0,0 +1,266 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include <cstdint>
+#include <simde/x86/svml.h>
+#include <simde/x86/avx2.h>
+#include <simde/x86/fma.h>
+#include <simde/x86/avx512.h>
+
+/**
+ * The instruction set the current translation unit is compiled for. The lattice and the update kernels are compiled
+ * once per instruction set and every variant lives in an inline namespace of this name, so the variants never collide
+ * at link time. Translation units which are not compiled as a kernel variant see the native namespace.
+ */
+#ifndef XY_ISA
+#define XY_ISA native
+#endif
+
+namespace utils {
+	inline namespace XY_ISA {
+		inline double_t mm256_reduce_add_pd(const simde__m256d v) {
+			simde__m128d low = simde_mm256_castpd256_pd128(v);
+			const simde__m128d high = simde_mm256_extractf128_pd(v, 1);
+			low = simde_mm_add_pd(low, high);
+
+			const simde__m128d high64 = simde_mm_unpackhi_pd(low, low);
+			return simde_mm_cvtsd_f64(simde_mm_add_sd(low, high64));
+		}
+
+		/**
+		 * Maps the scalar type of the lattice onto the widest register type of the instruction set and the intrinsics
+		 * operating on it. The lattice kernels are written once against this interface, so an AVX2 build processes four
+		 * doubles or eight floats per register while an AVX-512 build processes eight doubles or sixteen floats.
+		 *
+		 * @tparam T The scalar type of the spins (float or double)
+		 */
+		template<typename T>
+		struct simd;
+
+#if defined(__AVX512F__)
+		template<>
+		struct simd<double> {
+			using vector = simde__m512d;
+			using index = simde__m256i;
+			using mask = simde__mmask8;
+			static constexpr std::size_t lanes = 8;
+
+			static vector load(const double * p) noexcept { return simde_mm512_load_pd(p); }
+			static vector loadu(const double * p) noexcept { return simde_mm512_loadu_pd(p); }
+			static void store(double * p, const vector v) noexcept { simde_mm512_store_pd(p, v); }
+			static vector set1(const double v) noexcept { return simde_mm512_set1_pd(v); }
+			static vector zero() noexcept { return simde_mm512_setzero_pd(); }
+
+			static vector add(const vector a, const vector b) noexcept { return simde_mm512_add_pd(a, b); }
+			static vector sub(const vector a, const vector b) noexcept { return simde_mm512_sub_pd(a, b); }
+			static vector mul(const vector a, const vector b) noexcept { return simde_mm512_mul_pd(a, b); }
+			static vector fmadd(const vector a, const vector b, const vector c) noexcept { return simde_mm512_fmadd_pd(a, b, c); }
+			static vector min(const vector a, const vector b) noexcept { return simde_mm512_min_pd(a, b); }
+			static vector div(const vector a, const vector b) noexcept { return simde_mm512_div_pd(a, b); }
+			static vector sqrt(const vector v) noexcept { return simde_mm512_sqrt_pd(v); }
+			static mask greater(const vector a, const vector b) noexcept { return simde_mm512_cmp_pd_mask(a, b, SIMDE_CMP_GT_OQ); }
+			static vector select(const mask m, const vector v) noexcept { return simde_mm512_maskz_mov_pd(m, v); }
+			static vector blend(const mask m, const vector a, const vector b) noexcept { return simde_mm512_mask_blend_pd(m, a, b); }
+			static mask mask_and(const mask a, const mask b) noexcept { return static_cast<mask>(a & b); }
+			static mask mask_andnot(const mask a, const mask b) noexcept { return static_cast<mask>(a & ~b); }
+			static int32_t movemask(const mask m) noexcept { return static_cast<int32_t>(m); }
+
+			static vector cos(const vector v) noexcept { return simde_mm512_cos_pd(v); }
+			static vector sin(const vector v) noexcept { return simde_mm512_sin_pd(v); }
+			static vector sincos(vector * cos, const vector v) noexcept { return simde_mm512_sincos_pd(cos, v); }
+			static vector exp(const vector v) noexcept { return simde_mm512_exp_pd(v); }
+			static vector atan2(const vector y, const vector x) noexcept { return simde_mm512_atan2_pd(y, x); }
+			static vector floor(const vector v) noexcept { return simde_mm512_floor_pd(v); }
+
+			static index load_index(const int32_t * p) noexcept { return simde_mm256_load_si256(reinterpret_cast<const simde__m256i *>(p)); }
+			static void store_index(int32_t * p, const index i) noexcept { simde_mm256_store_si256(reinterpret_cast<simde__m256i *>(p), i); }
+			static vector gather(const double * base, const index i) noexcept { return simde_mm512_i32gather_pd(i, base, 8); }
+
+			/// Looks up the given column of a table with four entries per site, i.e. table[4 * sites + column]
+			static index gather_table(const int32_t * table, const index sites, const int32_t column) noexcept {
+				return simde_mm256_i32gather_epi32(table, simde_mm256_add_epi32(simde_mm256_slli_epi32(sites, 2), simde_mm256_set1_epi32(column)), 4);
+			}
+
+			/// Gathers four scalars and widens them to double precision
+			static simde__m256d gather_pd(const double * base, const simde__m128i i) noexcept { return simde_mm256_i32gather_pd(base, i, 8); }
+
+			/// Loads four consecutive scalars and widens them to double precision
+			static simde__m256d load_pd(const double * p) noexcept { return simde_mm256_load_pd(p); }
+
+			/// Folds both halves of the vector onto the double precision accumulator
+			static simde__m256d accumulate(const simde__m256d acc, const vector v) noexcept {
+				return simde_mm256_add_pd(acc, simde_mm256_add_pd(simde_mm512_castpd512_pd256(v), simde_mm512_extractf64x4_pd(v, 1)));
+			}
+		};
+
+		template<>
+		struct simd<float> {
+			using vector = simde__m512;
+			using index = simde__m512i;
+			using mask = simde__mmask16;
+			static constexpr std::size_t lanes = 16;
+
+			static vector load(const float * p) noexcept { return simde_mm512_load_ps(p); }
+			static vector loadu(const float * p) noexcept { return simde_mm512_loadu_ps(p); }
+			static void store(float * p, const vector v) noexcept { simde_mm512_store_ps(p, v); }
+			static vector set1(const float v) noexcept { return simde_mm512_set1_ps(v); }
+			static vector zero() noexcept { return simde_mm512_setzero_ps(); }
+
+			static vector add(const vector a, const vector b) noexcept { return simde_mm512_add_ps(a, b); }
+			static vector sub(const vector a, const vector b) noexcept { return simde_mm512_sub_ps(a, b); }
+			static vector mul(const vector a, const vector b) noexcept { return simde_mm512_mul_ps(a, b); }
+			static vector fmadd(const vector a, const vector b, const vector c) noexcept { return simde_mm512_fmadd_ps(a, b, c); }
+			static vector min(const vector a, const vector b) noexcept { return simde_mm512_min_ps(a, b); }
+			static vector div(const vector a, const vector b) noexcept { return simde_mm512_div_ps(a, b); }
+			static vector sqrt(const vector v) noexcept { return simde_mm512_sqrt_ps(v); }
+			static mask greater(const vector a, const vector b) noexcept { return simde_mm512_cmp_ps_mask(a, b, SIMDE_CMP_GT_OQ); }
+			static vector select(const mask m, const vector v) noexcept { return simde_mm512_maskz_mov_ps(m, v); }
+			static vector blend(const mask m, const vector a, const vector b) noexcept { return simde_mm512_mask_blend_ps(m, a, b); }
+			static mask mask_and(const mask a, const mask b) noexcept { return static_cast<mask>(a & b); }
+			static mask mask_andnot(const mask a, const mask b) noexcept { return static_cast<mask>(a & ~b); }
+			static int32_t movemask(const mask m) noexcept { return static_cast<int32_t>(m); }
+
+			static vector cos(const vector v) noexcept { return simde_mm512_cos_ps(v); }
+			static vector sin(const vector v) noexcept { return simde_mm512_sin_ps(v); }
+			static vector sincos(vector * cos, const vector v) noexcept { return simde_mm512_sincos_ps(cos, v); }
+			static vector exp(const vector v) noexcept { return simde_mm512_exp_ps(v); }
+			static vector atan2(const vector y, const vector x) noexcept { return simde_mm512_atan2_ps(y, x); }
+			static vector floor(const vector v) noexcept { return simde_mm512_floor_ps(v); }
+
+			static index load_index(const int32_t * p) noexcept { return simde_mm512_load_si512(p); }
+			static void store_index(int32_t * p, const index i) noexcept { simde_mm512_store_si512(p, i); }
+			static vector gather(const float * base, const index i) noexcept { return simde_mm512_i32gather_ps(i, base, 4); }
+
+			/// Looks up the given column of a table with four entries per site, i.e. table[4 * sites + column]
+			static index gather_table(const int32_t * table, const index sites, const int32_t column) noexcept {
+				return simde_mm512_i32gather_epi32(simde_mm512_add_epi32(simde_mm512_slli_epi32(sites, 2), simde_mm512_set1_epi32(column)), table, 4);
+			}
+
+			/// Gathers four scalars and widens them to double precision
+			static simde__m256d gather_pd(const float * base, const simde__m128i i) noexcept { return simde_mm256_cvtps_pd(simde_mm_i32gather_ps(base, i, 4)); }
+
+			/// Loads four consecutive scalars and widens them to double precision
+			static simde__m256d load_pd(const float * p) noexcept { return simde_mm256_cvtps_pd(simde_mm_load_ps(p)); }
+
+			/// Widens both halves of the vector and folds them onto the double precision accumulator
+			static simde__m256d accumulate(const simde__m256d acc, const vector v) noexcept {
+				const simde__m256 high = simde_mm256_castpd_ps(simde_mm512_extractf64x4_pd(simde_mm512_castps_pd(v), 1));
+				const simde__m512d sum = simde_mm512_add_pd(simde_mm512_cvtps_pd(simde_mm512_castps512_ps256(v)), simde_mm512_cvtps_pd(high));
+				return simde_mm256_add_pd(acc, simde_mm256_add_pd(simde_mm512_castpd512_pd256(sum), simde_mm512_extractf64x4_pd(sum, 1)));
+			}
+		};
+#else
+		template<>
+		struct simd<double> {
+			using vector = simde__m256d;
+			using index = simde__m128i;
+			using mask = simde__m256d;
+			static constexpr std::size_t lanes = 4;
+
+			static vector load(const double * p) noexcept { return simde_mm256_load_pd(p); }
+			static vector loadu(const double * p) noexcept { return simde_mm256_loadu_pd(p); }
+			static void store(double * p, const vector v) noexcept { simde_mm256_store_pd(p, v); }
+			static vector set1(const double v) noexcept { return simde_mm256_set1_pd(v); }
+			static vector zero() noexcept { return simde_mm256_setzero_pd(); }
+
+			static vector add(const vector a, const vector b) noexcept { return simde_mm256_add_pd(a, b); }
+			static vector sub(const vector a, const vector b) noexcept { return simde_mm256_sub_pd(a, b); }
+			static vector mul(const vector a, const vector b) noexcept { return simde_mm256_mul_pd(a, b); }
+			static vector fmadd(const vector a, const vector b, const vector c) noexcept { return simde_mm256_fmadd_pd(a, b, c); }
+			static vector min(const vector a, const vector b) noexcept { return simde_mm256_min_pd(a, b); }
+			static vector div(const vector a, const vector b) noexcept { return simde_mm256_div_pd(a, b); }
+			static vector sqrt(const vector v) noexcept { return simde_mm256_sqrt_pd(v); }
+			static mask greater(const vector a, const vector b) noexcept { return simde_mm256_cmp_pd(a, b, SIMDE_CMP_GT_OQ); }
+			static vector select(const mask m, const vector v) noexcept { return simde_mm256_and_pd(m, v); }
+			static vector blend(const mask m, const vector a, const vector b) noexcept { return simde_mm256_blendv_pd(a, b, m); }
+			static mask mask_and(const mask a, const mask b) noexcept { return simde_mm256_and_pd(a, b); }
+			static mask mask_andnot(const mask a, const mask b) noexcept { return simde_mm256_andnot_pd(b, a); }
+			static int32_t movemask(const mask m) noexcept { return simde_mm256_movemask_pd(m); }
+
+			static vector cos(const vector v) noexcept { return simde_mm256_cos_pd(v); }
+			static vector sin(const vector v) noexcept { return simde_mm256_sin_pd(v); }
+			static vector sincos(vector * cos, const vector v) noexcept { return simde_mm256_sincos_pd(cos, v); }
+			static vector exp(const vector v) noexcept { return simde_mm256_exp_pd(v); }
+			static vector atan2(const vector y, const vector x) noexcept { return simde_mm256_atan2_pd(y, x); }
+			static vector floor(const vector v) noexcept { return simde_mm256_floor_pd(v); }
+
+			static index load_index(const int32_t * p) noexcept { return simde_mm_load_si128(reinterpret_cast<const simde__m128i *>(p)); }
+			static void store_index(int32_t * p, const index i) noexcept { simde_mm_store_si128(reinterpret_cast<simde__m128i *>(p), i); }
+			static vector gather(const double * base, const index i) noexcept { return simde_mm256_i32gather_pd(base, i, 8); }
+
+			/// Looks up the given column of a table with four entries per site, i.e. table[4 * sites + column]
+			static index gather_table(const int32_t * table, const index sites, const int32_t column) noexcept {
+				return simde_mm_i32gather_epi32(table, simde_mm_add_epi32(simde_mm_slli_epi32(sites, 2), simde_mm_set1_epi32(column)), 4);
+			}
+
+			/// Gathers four scalars and widens them to double precision
+			static simde__m256d gather_pd(const double * base, const simde__m128i i) noexcept { return simde_mm256_i32gather_pd(base, i, 8); }
+
+			/// Loads four consecutive scalars and widens them to double precision
+			static simde__m256d load_pd(const double * p) noexcept { return simde_mm256_load_pd(p); }
+
+			/// Adds all lanes of the vector onto the double precision accumulator
+			static simde__m256d accumulate(const simde__m256d acc, const vector v) noexcept { return simde_mm256_add_pd(acc, v); }
+		};
+
+		template<>
+		struct simd<float> {
+			using vector = simde__m256;
+			using index = simde__m256i;
+			using mask = simde__m256;
+			static constexpr std::size_t lanes = 8;
+
+			static vector load(const float * p) noexcept { return simde_mm256_load_ps(p); }
+			static vector loadu(const float * p) noexcept { return simde_mm256_loadu_ps(p); }
+			static void store(float * p, const vector v) noexcept { simde_mm256_store_ps(p, v); }
+			static vector set1(const float v) noexcept { return simde_mm256_set1_ps(v); }
+			static vector zero() noexcept { return simde_mm256_setzero_ps(); }
+
+			static vector add(const vector a, const vector b) noexcept { return simde_mm256_add_ps(a, b); }
+			static vector sub(const vector a, const vector b) noexcept { return simde_mm256_sub_ps(a, b); }
+			static vector mul(const vector a, const vector b) noexcept { return simde_mm256_mul_ps(a, b); }
+			static vector fmadd(const vector a, const vector b, const vector c) noexcept { return simde_mm256_fmadd_ps(a, b, c); }
+			static vector min(const vector a, const vector b) noexcept { return simde_mm256_min_ps(a, b); }
+			static vector div(const vector a, const vector b) noexcept { return simde_mm256_div_ps(a, b); }
+			static vector sqrt(const vector v) noexcept { return simde_mm256_sqrt_ps(v); }
+			static mask greater(const vector a, const vector b) noexcept { return simde_mm256_cmp_ps(a, b, SIMDE_CMP_GT_OQ); }
+			static vector select(const mask m, const vector v) noexcept { return simde_mm256_and_ps(m, v); }
+			static vector blend(const mask m, const vector a, const vector b) noexcept { return simde_mm256_blendv_ps(a, b, m); }
+			static mask mask_and(const mask a, const mask b) noexcept { return simde_mm256_and_ps(a, b); }
+			static mask mask_andnot(const mask a, const mask b) noexcept { return simde_mm256_andnot_ps(b, a); }
+			static int32_t movemask(const mask m) noexcept { return simde_mm256_movemask_ps(m); }
+
+			static vector cos(const vector v) noexcept { return simde_mm256_cos_ps(v); }
+			static vector sin(const vector v) noexcept { return simde_mm256_sin_ps(v); }
+			static vector sincos(vector * cos, const vector v) noexcept { return simde_mm256_sincos_ps(cos, v); }
+			static vector exp(const vector v) noexcept { return simde_mm256_exp_ps(v); }
+			static vector atan2(const vector y, const vector x) noexcept { return simde_mm256_atan2_ps(y, x); }
+			static vector floor(const vector v) noexcept { return simde_mm256_floor_ps(v); }
+
+			static index load_index(const int32_t * p) noexcept { return simde_mm256_load_si256(reinterpret_cast<const simde__m256i *>(p)); }
+			static void store_index(int32_t * p, const index i) noexcept { simde_mm256_store_si256(reinterpret_cast<simde__m256i *>(p), i); }
+			static vector gather(const float * base, const index i) noexcept { return simde_mm256_i32gather_ps(base, i, 4); }
+
+			/// Looks up the given column of a table with four entries per site, i.e. table[4 * sites + column]
+			static index gather_table(const int32_t * table, const index sites, const int32_t column) noexcept {
+				return simde_mm256_i32gather_epi32(table, simde_mm256_add_epi32(simde_mm256_slli_epi32(sites, 2), simde_mm256_set1_epi32(column)), 4);
+			}
+
+			/// Gathers four scalars and widens them to double precision
+			static simde__m256d gather_pd(const float * base, const simde__m128i i) noexcept { return simde_mm256_cvtps_pd(simde_mm_i32gather_ps(base, i, 4)); }
+
+			/// Loads four consecutive scalars and widens them to double precision
+			static simde__m256d load_pd(const float * p) noexcept { return simde_mm256_cvtps_pd(simde_mm_load_ps(p)); }
+
+			/// Widens both halves of the vector and adds them onto the double precision accumulator
+			static simde__m256d accumulate(const simde__m256d acc, const vector v) noexcept {
+				const simde__m256d low = simde_mm256_cvtps_pd(simde_mm256_castps256_ps128(v));
+				const simde__m256d high = simde_mm256_cvtps_pd(simde_mm256_extractf128_ps(v, 1));
+				return simde_mm256_add_pd(acc, simde_mm256_add_pd(low, high));
+			}
+		};
+#endif
+	}
+}
+
+#endif //SIMD_HPP
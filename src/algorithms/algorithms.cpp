@@ -1,89 +1,370 @@
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <optional>
+#include <tbb/task_arena.h>
 
 #include "algorithms/algorithms.hpp"
+#include "algorithms/simulator.hpp"
+#include "algorithms/heat_bath.hpp"
 #include "algorithms/metropolis.hpp"
+#include "algorithms/over_relaxation.hpp"
+#include "algorithms/swendsen_wang.hpp"
 #include "algorithms/wolff.hpp"
+#include "batch_lattice.hpp"
 
 /**
- *
+ * Pushes the observables of the current state of a lattice into the sink. The squares of the energy and of the
+ * magnetization are pushed along with them, so they never have to be derived from a copy of the time series.
+ */
+static void record(observables::Sink & sink, const double_t energy, const double_t helicity_modulus, const double_t magnet_cos, const double_t magnet_sin, const double_t norm) {
+	const auto magnetization = std::sqrt(std::pow(magnet_cos, 2.0) + std::pow(magnet_sin, 2.0)) * norm;
+	sink.push(observables::Energy, energy * norm);
+	sink.push(observables::EnergySquared, std::pow(energy * norm, 2.0));
+	sink.push(observables::Magnetization, magnetization);
+	sink.push(observables::MagnetizationSquared, std::pow(magnetization, 2.0));
+	sink.push(observables::HelicityModulusIntermediate, std::pow(helicity_modulus, 2.0) * norm);
+}
+
+/**
+ * Tunes the width of the Metropolis proposal window towards the target acceptance rate. Each unrecorded sweep scales the
+ * width by exp(acceptance - target), so the width grows while too many proposals are accepted and shrinks otherwise.
+ * Tuning only happens ahead of the first chunk of a configuration and the width stays fixed afterwards, so the recorded
+ * Markov chain keeps a fixed transition kernel and detailed balance holds.
+ */
+template<typename T>
+static void tune_proposal_window(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng, const bool checkerboard, const algorithms::Options & options, algorithms::ProposalWindow & window) {
+	const auto norm = 1.0 / static_cast<double_t>(lattice.num_sites());
+	for (std::size_t i = 0; i < options.tuning_sweeps; ++i) {
+		const auto accepted = get<3>(checkerboard ? algorithms::metropolis_checkerboard(lattice, rng, window.width) : algorithms::metropolis(lattice, rng, window.width));
+		const auto acceptance = static_cast<double_t>(accepted) * norm;
+		window.width = std::clamp(window.width * std::exp(acceptance - options.target_acceptance), 1e-3, algorithms::N_PI<2>);
+	}
+	window.tuned = true;
+}
+
+/**
+ * @return Whether the single site updates visit the lattice in checkerboard order. Lattices too small to fill whole
+ * registers with each sublattice fall back to the sequential sweep.
+ */
+template<typename T>
+static bool uses_checkerboard(const BasicLattice<T> & lattice, const algorithms::Options & options) noexcept {
+	return options.sweep == algorithms::CHECKERBOARD && lattice.num_sites() / 2 % BasicLattice<T>::simd::lanes == 0;
+}
+
+namespace algorithms {
+	inline namespace XY_ISA {
+		/**
+		 * Everything a run of a lattice carries from one call to the next: the random streams, the arena of the lent
+		 * threads, the running observables and the workspaces of the cluster algorithms. A caller interleaving short
+		 * stretches of sweeps with other work, like the replica exchange, thus only pays for the sweeps themselves.
+		 */
+		template<typename T>
+		struct Run {
+			Run(BasicLattice<T> & lattice, XoshiroCpp::Xoshiro256Plus & rng, const Algorithm algorithm, const Options & options, ProposalWindow & window)
+				: algorithm(algorithm), streams(rng), arena(static_cast<int>(std::max<std::size_t>(options.threads, 1))) {
+				// Every strip of a lattice updated on multiple threads draws from its own streams
+				if (algorithm == METROPOLIS && options.threads > 1) {
+					strips.reserve(options.threads);
+					for (std::size_t i = 0; i < options.threads; ++i) strips.emplace_back(rng);
+				}
+
+				// Uniform proposals always draw a completely new angle, adaptive ones are tuned once per configuration
+				if (algorithm == METROPOLIS && options.proposal == UNIFORM) {
+					window = {};
+				} else if (algorithm == METROPOLIS && !window.tuned) {
+					tune_proposal_window(lattice, streams, uses_checkerboard(lattice, options), options, window);
+				}
+
+				if (algorithm == WOLFF) workspace.emplace(lattice.num_sites());
+				if (algorithm == SWENDSEN_WANG) forest.emplace(lattice.num_sites());
+				measure(lattice);
+			}
+
+			/**
+			 * Replaces the running observables by a fresh measurement on the lattice.
+			 */
+			void measure(const BasicLattice<T> & lattice) noexcept {
+				const auto [measured_energy, measured_helicity_modulus, measured_magnet] = lattice.observables();
+				energy = measured_energy;
+				helicity_modulus = measured_helicity_modulus;
+				std::tie(magnet_cos, magnet_sin) = measured_magnet;
+			}
+
+			/**
+			 * Adds the changes of a sweep to the running observables.
+			 */
+			template<typename TChanges>
+			void apply(const TChanges & changes) noexcept {
+				energy += get<0>(changes);
+				helicity_modulus += get<1>(changes);
+				magnet_cos += get<0>(get<2>(changes));
+				magnet_sin += get<1>(get<2>(changes));
+			}
+
+			const Algorithm algorithm;
+
+			/// The kernels draw their random numbers in bulk from independent streams split off the seeding generator
+			utils::SimdXoshiro256Plus streams;
+			std::vector<utils::SimdXoshiro256Plus> strips;
+
+			/// The parallel kernels only run on as many threads as were lent to this lattice, so they never take the
+			/// cores of other busy workers
+			tbb::task_arena arena;
+
+			double_t energy = 0.0, helicity_modulus = 0.0, magnet_cos = 0.0, magnet_sin = 0.0;
+
+			/// The sweeps performed and the Metropolis proposals accepted since the run started
+			std::size_t sweeps = 0, accepted = 0;
+
+			std::optional<ClusterWorkspace> workspace;
+			std::optional<ClusterForest> forest;
+		};
+	}
+}
+
+/**
+ * Replaces the running observables of a run by a fresh measurement every recompute interval, before their rounding
+ * errors pile up.
  */
-constexpr std::string_view AlgorithmStrings[] =
-{
-	"Metropolis",
-	"Wolff"
-};
-
-std::ostream& algorithms::operator<<(std::ostream& out, const Algorithm value) {
-	return out << AlgorithmStrings[static_cast<std::size_t>(value)];
+template<typename T>
+static void recompute(const BasicLattice<T> & lattice, algorithms::Run<T> & run, const algorithms::Options & options) noexcept {
+	if (options.recompute_interval > 0 && run.sweeps % options.recompute_interval == 0) {
+		run.measure(lattice);
+	}
 }
 
-static std::unordered_map<observables::Type, std::vector<double_t>> simulate_metropolis(Lattice & lattice, XoshiroCpp::Xoshiro256Plus & rng, const std::size_t sweeps) {
-	auto current_energy = lattice.energy();
-	auto current_helicity_modulus = lattice.helicity_modulus();
-	auto [current_magnet_cos, current_magnet_sin] = lattice.magnetization();
+/**
+ * Runs the single site updates, i.e. Metropolis or heat bath sweeps, optionally interleaved with over-relaxation sweeps.
+ */
+template<typename T>
+static void simulate_local(BasicLattice<T> & lattice, algorithms::Run<T> & run, const std::size_t sweeps, const algorithms::Options & options, algorithms::ProposalWindow & window, observables::Sink & sink) {
+	const auto checkerboard = uses_checkerboard(lattice, options);
+
+	// Threads lent to a single lattice split each sublattice into strips of at least one register, which forces the
+	// checkerboard order onto the Metropolis sweeps
+	const auto parallel = !run.strips.empty() && lattice.num_sites() / 2 / BasicLattice<T>::simd::lanes >= run.strips.size() && lattice.num_sites() / 2 % BasicLattice<T>::simd::lanes == 0;
 
 	const auto norm = 1.0 / static_cast<double_t>(lattice.num_sites());
-	std::vector<double_t> energies (sweeps), helicity_modulus (sweeps), magnets (sweeps);
 
 	for (std::size_t i = 0; i < sweeps; ++i) {
-		const auto [chg_energy, chg_helicity_modulus, chg_magnet] = algorithms::metropolis(lattice, rng);
-		current_magnet_cos += get<0>(chg_magnet);
-		current_magnet_sin += get<1>(chg_magnet);
-		current_energy += chg_energy;
-		current_helicity_modulus += chg_helicity_modulus;
-
-		energies[i] = current_energy * norm;
-		helicity_modulus[i] = std::pow(current_helicity_modulus, 2.0) * norm;
-		magnets[i] = std::sqrt(std::pow(current_magnet_cos, 2.0) + std::pow(current_magnet_sin, 2.0)) * norm;
+		// Cheap deterministic over-relaxation sweeps decorrelate the spins between two ergodic sweeps
+		for (std::size_t j = 0; j < options.over_relaxation; ++j) {
+			run.apply(checkerboard ? algorithms::over_relaxation_checkerboard(lattice) : algorithms::over_relaxation(lattice));
+		}
+
+		if (run.algorithm == algorithms::HEAT_BATH) {
+			run.apply(checkerboard ? algorithms::heat_bath_checkerboard(lattice, run.streams) : algorithms::heat_bath(lattice, run.streams));
+		} else {
+			const auto changes = parallel ? algorithms::metropolis_parallel(lattice, std::span { run.strips }, window.width)
+				: checkerboard ? algorithms::metropolis_checkerboard(lattice, run.streams, window.width) : algorithms::metropolis(lattice, run.streams, window.width);
+			run.accepted += get<3>(changes);
+			run.apply(changes);
+		}
+
+		run.sweeps++;
+		recompute(lattice, run, options);
+		record(sink, run.energy, run.helicity_modulus, run.magnet_cos, run.magnet_sin, norm);
 	}
 
-	return {{ observables::Type::Energy, energies }, { observables::Type::Magnetization, magnets }, { observables::Type::HelicityModulusIntermediate, helicity_modulus }};
+	window.acceptance = run.sweeps > 0 ? static_cast<double_t>(run.accepted) * norm / static_cast<double_t>(run.sweeps) : 0.0;
 }
 
-static std::unordered_map<observables::Type, std::vector<double_t>> simulate_wolff(Lattice & lattice, XoshiroCpp::Xoshiro256Plus & rng, const std::size_t sweeps) {
-	// Prepare rolling observables
-	auto current_energy = lattice.energy(), current_helicity_modulus = lattice.helicity_modulus();
-	auto [current_magnet_cos, current_magnet_sin] = lattice.magnetization();
-
-	// Calculates the normalization factor and prepare result vectors
+template<typename T>
+static void simulate_wolff(BasicLattice<T> & lattice, algorithms::Run<T> & run, const std::size_t sweeps, const algorithms::Options & options, observables::Sink & sink) {
+	// Calculates the normalization factor
 	const auto norm = 1.0 / static_cast<double_t>(lattice.num_sites());
-	std::vector<double_t> energies (sweeps), helicity_modulus (sweeps), magnets (sweeps), clusters (sweeps);
 
 	for (std::size_t i = 0; i < sweeps; ++i) {
 		std::size_t sub_sweeps = 0;
+		double_t clusters = 0.0;
 		for (std::size_t total_visited = 0; total_visited < lattice.num_sites(); ++sub_sweeps) {
-			// Perform the Wolff sweep
-			const auto [chg_energy, chg_helicity_modulus, chg_magnet, cluster_size, visited] = algorithms::wolff(lattice, rng);
-
-			// Apply change to our observables
-			current_energy += chg_energy;
-			current_magnet_cos += get<0>(chg_magnet);
-			current_magnet_sin += get<1>(chg_magnet);
-			current_helicity_modulus += chg_helicity_modulus;
-			clusters[i] += cluster_size;
+			// Perform the Wolff sweep and apply the change to our observables
+			const auto changes = algorithms::wolff(lattice, run.streams, *run.workspace);
+			run.apply(changes);
+			clusters += get<3>(changes);
 
 			// Total visited sites stabilizes the algorithm for T >= 1.0
-			total_visited += visited;
+			total_visited += get<4>(changes);
 		}
 
-		// Add the current value of the rolling observables to the result vectors
-		clusters[i] /= static_cast<double_t>(sub_sweeps);
-		energies[i] = current_energy * norm;
-		helicity_modulus[i] = std::pow(current_helicity_modulus, 2.0) * norm;
-		magnets[i] = std::sqrt(std::pow(current_magnet_cos, 2.0) + std::pow(current_magnet_sin, 2.0)) * norm;
+		// Push the current value of the rolling observables into the sink
+		run.sweeps++;
+		recompute(lattice, run, options);
+		record(sink, run.energy, run.helicity_modulus, run.magnet_cos, run.magnet_sin, norm);
+		sink.push(observables::ClusterSize, clusters / static_cast<double_t>(sub_sweeps));
 	}
+}
 
-	// Returns our observables
-	return {
-		{observables::Type::Energy, energies}, {observables::Type::Magnetization, magnets},
-		{observables::Type::HelicityModulusIntermediate, helicity_modulus}, {observables::Type::ClusterSize, clusters}
+/**
+ * Runs Swendsen-Wang sweeps. Neighbouring sites flip together, so the change of a sweep cannot be summed up site by site
+ * and the observables are measured on the lattice after every sweep instead, in a single pass.
+ */
+template<typename T>
+static void simulate_swendsen_wang(BasicLattice<T> & lattice, algorithms::Run<T> & run, const std::size_t sweeps, observables::Sink & sink) {
+	const auto norm = 1.0 / static_cast<double_t>(lattice.num_sites());
+
+	for (std::size_t i = 0; i < sweeps; ++i) {
+		algorithms::swendsen_wang(lattice, run.streams, *run.forest);
+
+		run.sweeps++;
+		run.measure(lattice);
+		record(sink, run.energy, run.helicity_modulus, run.magnet_cos, run.magnet_sin, norm);
+	}
+}
+
+/**
+ * Continues a run for the given number of sweeps and pushes the observables of every sweep into the sink.
+ */
+template<typename T>
+static void simulate_run(BasicLattice<T> & lattice, algorithms::Run<T> & run, const std::size_t sweeps, const algorithms::Options & options, algorithms::ProposalWindow & window, observables::Sink & sink) {
+	run.arena.execute([&] {
+		switch (run.algorithm) {
+			case algorithms::WOLFF: simulate_wolff(lattice, run, sweeps, options, sink); break;
+			case algorithms::SWENDSEN_WANG: simulate_swendsen_wang(lattice, run, sweeps, sink); break;
+			default: simulate_local(lattice, run, sweeps, options, window, sink); break;
+		}
+	});
+}
+
+/**
+ * Runs uniform Metropolis sweeps over all replicas of a batch. The running observables are kept per lane and only spilled
+ * into the sinks of the replicas once per sweep.
+ *
+ * @return The acceptance rate of every replica.
+ */
+static BatchLattice::values simulate_batch(BatchLattice & lattice, XoshiroCpp::Xoshiro256Plus & rng, const std::size_t sweeps, const algorithms::Options & options, const std::span<observables::Sink *> sinks) {
+	using simd = BatchLattice::simd;
+	utils::SimdXoshiro256Plus streams { rng };
+
+	BatchLattice::vector current_energy, current_helicity_modulus, current_magnet_cos, current_magnet_sin;
+	const auto measure = [&] {
+		const auto [energy, helicity_modulus, magnet] = lattice.observables();
+		current_energy = energy;
+		current_helicity_modulus = helicity_modulus;
+		std::tie(current_magnet_cos, current_magnet_sin) = magnet;
 	};
+
+	measure();
+	auto accepted = simd::zero();
+
+	const auto norm = 1.0 / static_cast<double_t>(lattice.num_sites());
+
+	for (std::size_t i = 0; i < sweeps; ++i) {
+		const auto [chg_energy, chg_helicity_modulus, chg_magnet, chg_accepted] = algorithms::metropolis_batch(lattice, streams);
+		current_energy = simd::add(current_energy, chg_energy);
+		current_helicity_modulus = simd::add(current_helicity_modulus, chg_helicity_modulus);
+		current_magnet_cos = simd::add(current_magnet_cos, get<0>(chg_magnet));
+		current_magnet_sin = simd::add(current_magnet_sin, get<1>(chg_magnet));
+		accepted = simd::add(accepted, chg_accepted);
+
+		// Replace the running sums by a fresh measurement before their rounding errors pile up
+		if (options.recompute_interval > 0 && (i + 1) % options.recompute_interval == 0) {
+			measure();
+		}
+
+		const auto energy = BatchLattice::split(current_energy), helicity = BatchLattice::split(current_helicity_modulus);
+		const auto magnet_cos = BatchLattice::split(current_magnet_cos), magnet_sin = BatchLattice::split(current_magnet_sin);
+		for (std::size_t r = 0; r < sinks.size(); ++r) {
+			record(*sinks[r], energy[r], helicity[r], magnet_cos[r], magnet_sin[r], norm);
+		}
+	}
+
+	auto acceptance = BatchLattice::split(accepted);
+	for (auto & value : acceptance) value = sweeps > 0 ? value * norm / static_cast<double_t>(sweeps) : 0.0;
+	return acceptance;
 }
 
-std::unordered_map<observables::Type, std::vector<double_t>> algorithms::simulate(Lattice & lattice, XoshiroCpp::Xoshiro256Plus & rng, const std::size_t sweeps, const Algorithm algorithm) noexcept {
-	auto result = algorithm == WOLFF ? simulate_wolff(lattice, rng, sweeps) : simulate_metropolis(lattice, rng, sweeps);
-	result[observables::EnergySquared] = utils::square_elements(result[observables::Energy]);
-	result[observables::MagnetizationSquared] = utils::square_elements(result[observables::Magnetization]);
-	return result;
-}
\ No newline at end of file
+namespace algorithms {
+	inline namespace XY_ISA {
+		/**
+		 * Owns a lattice of the given precision and runs the kernels of the instruction set this file is compiled for.
+		 */
+		template<typename T>
+		class LatticeSimulator final : public Simulator {
+		public:
+			LatticeSimulator(const std::size_t length, const double_t beta, const std::optional<std::vector<double_t>> & spins, const Options & options)
+				: lattice(length, beta, spins, options.representation), options(options) {
+
+			}
+
+			void start(XoshiroCpp::Xoshiro256Plus & rng, const Algorithm algorithm) override {
+				run.reset();
+				run.emplace(lattice, rng, algorithm, options, window);
+			}
+
+			void advance(const std::size_t sweeps, observables::Sink & sink) override {
+				assert(run.has_value() && "A run has to be started before it is advanced");
+				simulate_run(lattice, *run, sweeps, options, window, sink);
+			}
+
+			void set_beta(const double_t beta) override {
+				lattice.set_beta(beta);
+			}
+
+			void set_proposal_width(const double_t width) override {
+				window.width = width;
+				window.tuned = true;
+			}
+
+			[[nodiscard]] ProposalWindow get_proposal_window() const override {
+				return window;
+			}
+
+			[[nodiscard]] std::vector<double_t> get_spins() const override {
+				return lattice.get_spins();
+			}
+
+		private:
+			BasicLattice<T> lattice;
+			const Options options;
+			ProposalWindow window;
+			std::optional<Run<T>> run;
+		};
+
+		/**
+		 * Owns one register worth of replicas and runs the batched kernels of the instruction set this file is compiled for.
+		 */
+		class BatchLatticeSimulator final : public BatchSimulator {
+		public:
+			BatchLatticeSimulator(const std::size_t length, const std::vector<double_t> & betas, const std::vector<std::optional<std::vector<double_t>>> & spins, const Options & options)
+				: lattice(length, betas, spins), options(options), count(betas.size()) {
+
+			}
+
+			void simulate(XoshiroCpp::Xoshiro256Plus & rng, const std::size_t sweeps, const std::span<observables::Sink *> sinks) override {
+				assert(sinks.size() == count && "Every replica requires its own sink");
+				acceptance = simulate_batch(lattice, rng, sweeps, options, sinks);
+			}
+
+			[[nodiscard]] ProposalWindow get_proposal_window(const std::size_t replica) const override {
+				return { N_PI<2>, acceptance[replica], false };
+			}
+
+			[[nodiscard]] std::vector<double_t> get_spins(const std::size_t replica) const override {
+				return lattice.get_spins(replica);
+			}
+
+		private:
+			BatchLattice lattice;
+			const Options options;
+			const std::size_t count;
+			BatchLattice::values acceptance {};
+		};
+	}
+}
+
+std::unique_ptr<algorithms::Simulator> algorithms::XY_ISA::create_simulator(const std::size_t length, const double_t beta, const std::optional<std::vector<double_t>> & spins, const Options & options) {
+	if (options.precision == SINGLE) {
+		return std::make_unique<LatticeSimulator<float>>(length, beta, spins, options);
+	}
+	return std::make_unique<LatticeSimulator<double_t>>(length, beta, spins, options);
+}
+
+std::unique_ptr<algorithms::BatchSimulator> algorithms::XY_ISA::create_batch_simulator(const std::size_t length, const std::vector<double_t> & betas, const std::vector<std::optional<std::vector<double_t>>> & spins, const Options & options) {
+	return std::make_unique<BatchLatticeSimulator>(length, betas, spins, options);
+}
+
+std::size_t algorithms::XY_ISA::batch_replicas() noexcept {
+	return BatchLattice::replicas;
+}
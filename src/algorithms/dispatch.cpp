@@ -0,0 +1,169 @@
+#include <numeric>
+
+#include "algorithms/algorithms.hpp"
+#include "algorithms/simulator.hpp"
+
+/**
+ *
+ */
+constexpr std::string_view AlgorithmStrings[] =
+{
+	"Metropolis",
+	"Wolff",
+	"HeatBath",
+	"SwendsenWang"
+};
+
+std::ostream& algorithms::operator<<(std::ostream& out, const Algorithm value) {
+	return out << AlgorithmStrings[static_cast<std::size_t>(value)];
+}
+
+constexpr std::string_view IsaStrings[] =
+{
+	"SSE2",
+	"AVX2",
+	"AVX-512"
+};
+
+std::ostream& algorithms::operator<<(std::ostream& out, const Isa value) {
+	return out << IsaStrings[static_cast<std::size_t>(value)];
+}
+
+// The factories of the kernel variants. Each of them is compiled from algorithms.cpp with its own instruction set.
+namespace algorithms::sse2 {
+	std::unique_ptr<Simulator> create_simulator(std::size_t length, double_t beta, const std::optional<std::vector<double_t>> & spins, const Options & options);
+
+	std::unique_ptr<BatchSimulator> create_batch_simulator(std::size_t length, const std::vector<double_t> & betas, const std::vector<std::optional<std::vector<double_t>>> & spins, const Options & options);
+
+	std::size_t batch_replicas() noexcept;
+}
+
+namespace algorithms::avx2 {
+	std::unique_ptr<Simulator> create_simulator(std::size_t length, double_t beta, const std::optional<std::vector<double_t>> & spins, const Options & options);
+
+	std::unique_ptr<BatchSimulator> create_batch_simulator(std::size_t length, const std::vector<double_t> & betas, const std::vector<std::optional<std::vector<double_t>>> & spins, const Options & options);
+
+	std::size_t batch_replicas() noexcept;
+}
+
+namespace algorithms::avx512 {
+	std::unique_ptr<Simulator> create_simulator(std::size_t length, double_t beta, const std::optional<std::vector<double_t>> & spins, const Options & options);
+
+	std::unique_ptr<BatchSimulator> create_batch_simulator(std::size_t length, const std::vector<double_t> & betas, const std::vector<std::optional<std::vector<double_t>>> & spins, const Options & options);
+
+	std::size_t batch_replicas() noexcept;
+}
+
+/**
+ * Queries cpuid for the widest instruction set the kernels are compiled for. The AVX2 kernels make use of FMA, which
+ * every AVX-512 capable CPU supports as well.
+ *
+ * @return The best instruction set supported by the CPU.
+ */
+algorithms::Isa algorithms::detect_isa() noexcept {
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		return AVX512;
+	}
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		return AVX2;
+	}
+	return SSE2;
+}
+
+/**
+ * Creates a lattice and binds it to the kernels of the best instruction set supported by the CPU. The instruction set
+ * is only detected once per process.
+ *
+ * @param length The side length of the lattice
+ * @param beta The inverse temperature of the lattice
+ * @param spins The initial spins or none for a cold lattice
+ * @param options The options of the algorithm, which also select the precision of the lattice
+ * @return The simulator owning the lattice.
+ */
+std::unique_ptr<algorithms::Simulator> algorithms::make_simulator(const std::size_t length, const double_t beta, const std::optional<std::vector<double_t>> & spins, const Options & options) {
+	static const auto isa = detect_isa();
+	switch (isa) {
+		case AVX512: return avx512::create_simulator(length, beta, spins, options);
+		case AVX2: return avx2::create_simulator(length, beta, spins, options);
+		default: return sse2::create_simulator(length, beta, spins, options);
+	}
+}
+
+/**
+ * Batches interleave the replicas per site in double precision and draw completely new angles, which rules out single
+ * precision, adaptive proposals and over-relaxation.
+ */
+bool algorithms::supports_batch(const Algorithm algorithm, const Options & options) noexcept {
+	return options.batch && algorithm == METROPOLIS && options.precision == DOUBLE && options.proposal == UNIFORM && options.over_relaxation == 0;
+}
+
+/**
+ * Metropolis splits the sublattices into strips and Swendsen-Wang labels the clusters strip by strip, while Wolff and
+ * heat bath sweeps never leave the calling thread.
+ */
+bool algorithms::supports_threads(const Algorithm algorithm) noexcept {
+	return algorithm == METROPOLIS || algorithm == SWENDSEN_WANG;
+}
+
+std::size_t algorithms::batch_width() noexcept {
+	static const auto isa = detect_isa();
+	switch (isa) {
+		case AVX512: return avx512::batch_replicas();
+		case AVX2: return avx2::batch_replicas();
+		default: return sse2::batch_replicas();
+	}
+}
+
+/**
+ * Creates one register worth of lattices and binds them to the kernels of the best instruction set supported by the CPU.
+ *
+ * @param length The side length of all lattices
+ * @param betas The inverse temperature of every replica, at most batch_width() of them
+ * @param spins The initial spins of every replica or none for a cold lattice
+ * @return The simulator owning the replicas.
+ */
+std::unique_ptr<algorithms::BatchSimulator> algorithms::make_batch_simulator(const std::size_t length, const std::vector<double_t> & betas, const std::vector<std::optional<std::vector<double_t>>> & spins, const Options & options) {
+	static const auto isa = detect_isa();
+	switch (isa) {
+		case AVX512: return avx512::create_batch_simulator(length, betas, spins, options);
+		case AVX2: return avx2::create_batch_simulator(length, betas, spins, options);
+		default: return sse2::create_batch_simulator(length, betas, spins, options);
+	}
+}
+
+/**
+ * Simulates a cold lattice once with double and once with single precision spins. Both runs start from the same seed
+ * and only differ in the precision of the lattice, so any difference of the estimates beyond the statistical error
+ * points to a loss of precision in the single precision kernels. The first half of every time series is discarded as
+ * thermalization and the remaining sweeps are averaged.
+ *
+ * @brief Compares the estimates of a single and a double precision simulation on the same seed.
+ *
+ * @param length The side length of the lattice
+ * @param temperature The temperature at which both lattices are simulated
+ * @param sweeps The number of sweeps for each of the two runs
+ * @param seed The seed used for both runs
+ * @param algorithm The algorithm to simulate with
+ * @param options The options of the algorithm. The precision is ignored.
+ * @return The mean of every observable in double and in single precision.
+ */
+std::unordered_map<observables::Type, std::tuple<double_t, double_t>> algorithms::validate_precision(const std::size_t length, const double_t temperature, const std::size_t sweeps, const std::uint64_t seed, const Algorithm algorithm, const Options & options) noexcept {
+	const auto mean = [&] (const std::vector<double_t> & values) {
+		return std::accumulate(values.begin() + static_cast<std::ptrdiff_t>(sweeps / 2), values.end(), 0.0) / static_cast<double_t>(sweeps - sweeps / 2);
+	};
+
+	Options double_options = options, single_options = options;
+	double_options.precision = DOUBLE;
+	single_options.precision = SINGLE;
+
+	XoshiroCpp::Xoshiro256Plus rng_double { seed }, rng_single { seed };
+	const auto result_double = make_simulator(length, 1.0 / temperature, std::nullopt, double_options)->simulate(rng_double, sweeps, algorithm);
+	const auto result_single = make_simulator(length, 1.0 / temperature, std::nullopt, single_options)->simulate(rng_single, sweeps, algorithm);
+
+	std::unordered_map<observables::Type, std::tuple<double_t, double_t>> result;
+	for (const auto & [type, values] : result_double) {
+		result[type] = { mean(values), mean(result_single.at(type)) };
+	}
+	return result;
+}
\ No newline at end of file
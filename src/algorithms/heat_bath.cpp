@@ -0,0 +1,168 @@
+#include <cassert>
+#include <simde/x86/avx2.h>
+
+#include "algorithms/heat_bath.hpp"
+
+/**
+ * Samples the deviation from the mean direction of a von Mises distribution with concentration kappa using the wrapped
+ * Cauchy envelope of Best and Fisher (1979). The original acceptance test log(c / u) + 1 - c >= 0 is evaluated as
+ * c * exp(1 - c) > u and the angle arccos(f) as 2 * atan(tan(a) * (1 - rho) / (1 + rho)) with a = PI * u / 2. Both forms
+ * stay accurate for kappa -> 0 and for large kappa, where f is close to one. On average fewer than 1.5 tries are needed.
+ *
+ * @param kappa The concentration, i.e. beta times the magnitude of the local field
+ * @param rng The random number generator to draw the uniforms from
+ * @return The sampled deviation on (-PI, PI)
+ */
+static double_t von_mises(const double_t kappa, utils::SimdXoshiro256Plus & rng) noexcept {
+    const auto tau = 1.0 + std::sqrt(1.0 + 4.0 * kappa * kappa);
+    const auto root = tau + std::sqrt(2.0 * tau);
+    const auto rho = 2.0 * kappa / root;
+    const auto kappa_r = (1.0 + rho * rho) * root / 4.0;
+
+    while (true) {
+        const auto a = algorithms::N_PI<1> / 2.0 * rng.next();
+        const auto cos_a = std::cos(a), sin_a = std::sin(a);
+
+        const auto z = cos_a * cos_a - sin_a * sin_a;
+        const auto f = (2.0 * rho + (1.0 + rho * rho) * z) / (1.0 + rho * rho + 2.0 * rho * z);
+        const auto c = kappa_r - kappa * f;
+
+        if (c * std::exp(1.0 - c) > rng.next()) {
+            const auto theta = 2.0 * std::atan2(sin_a * (1.0 - rho), cos_a * (1.0 + rho));
+            return rng.next() < 0.5 ? -theta : theta;
+        }
+    }
+}
+
+/**
+ * Performs a single heat bath sweep over the given lattice. A single sweep visits every lattice site in order of the
+ * underlying vector and draws a new angle for the spin directly from its conditional distribution given the
+ * neighbours, the von Mises distribution around the local field. Unlike Metropolis no proposal is ever rejected, which
+ * keeps the sweep effective at low temperatures.
+ *
+ * @brief Performs a single heat bath sweep over the given lattice.
+ *
+ * @param lattice The lattice over which the sweep should be made.
+ * @param rng The random number generator to use for sampling the new angles.
+ * @return The total change of energy and magnetization once every lattice site is visited.
+ */
+template<typename T>
+std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::heat_bath(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng) noexcept {
+    // Prepares the result objects containing the total change of energy and magnetization
+    double_t chg_energy = 0.0, chg_helicity_modulus = 0.0, chg_magnet_cos = 0.0, chg_magnet_sin = 0.0;
+
+    for (std::size_t i = 0; i < lattice.num_sites(); ++i) {
+        const auto [field_cos, field_sin] = lattice.local_field(i);
+        const auto kappa = lattice.get_beta() * std::hypot(field_cos, field_sin);
+        const auto phi = std::atan2(field_sin, field_cos);
+
+        // phi is on (-PI, PI] and the deviation on (-PI, PI), so adding 2PI makes the sum positive before wrapping it
+        const auto proposal = lattice.propose(std::fmod(phi + von_mises(kappa, rng) + N_PI<2>, N_PI<2>));
+
+        const auto changes = lattice.changes(i, proposal);
+        chg_energy += changes.energy;
+        chg_helicity_modulus += changes.helicity_modulus;
+        chg_magnet_cos += changes.magnet_cos;
+        chg_magnet_sin += changes.magnet_sin;
+
+        lattice.set(i, proposal);
+    }
+
+    return {chg_energy, chg_helicity_modulus, {chg_magnet_cos, chg_magnet_sin}};
+}
+
+/**
+ * Performs a single heat bath sweep over the given lattice in checkerboard order. The von Mises sampler runs on a whole
+ * register of sites of the same sublattice at once. Lanes keep drawing new uniforms until their envelope test succeeds,
+ * lanes which are already done are masked out of every further try.
+ *
+ * @brief Performs a single heat bath sweep over the given lattice in checkerboard order.
+ *
+ * @param lattice The lattice over which the sweep should be made. Each sublattice must fill whole registers.
+ * @param rng The random number generator to use for sampling the new angles.
+ * @return The total change of energy and magnetization once every lattice site is visited.
+ */
+template<typename T>
+std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::heat_bath_checkerboard(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng) noexcept {
+    using simd = utils::simd<T>;
+    assert(lattice.num_sites() / 2 % simd::lanes == 0 && "Checkerboard sweeps require each sublattice to fill whole registers");
+
+    // Prepares the result vectors containing the total change of energy and magnetization per lane
+    simde__m256d chg_energy = simde_mm256_setzero_pd(), chg_helicity_modulus = simde_mm256_setzero_pd();
+    simde__m256d chg_magnet_cos = simde_mm256_setzero_pd(), chg_magnet_sin = simde_mm256_setzero_pd();
+
+    const auto zero = simd::zero(), one = simd::set1(1.0), two = simd::set1(2.0), half_one = simd::set1(0.5);
+    const auto half_pi = simd::set1(static_cast<T>(N_PI<1> / 2.0)), two_pi = simd::set1(static_cast<T>(N_PI<2>));
+    const auto beta = simd::set1(static_cast<T>(lattice.get_beta()));
+
+    // Every lane is accepted
+    constexpr auto all = static_cast<int32_t>((1ULL << simd::lanes) - 1);
+
+    // One register of uniforms each for the half angle, the envelope test and the sign
+    alignas(64) T uniforms[3 * simd::lanes];
+
+    const auto half = lattice.num_sites() / 2;
+    for (std::size_t color = 0; color < 2; ++color) {
+        for (std::size_t k = 0; k < half; k += simd::lanes) {
+            const auto sites = lattice.sublattice_sites(color, k);
+            const auto [field_cos, field_sin] = lattice.local_field(sites);
+
+            const auto kappa = simd::mul(beta, simd::sqrt(simd::fmadd(field_cos, field_cos, simd::mul(field_sin, field_sin))));
+            const auto phi = simd::atan2(field_sin, field_cos);
+
+            // The parameters of the envelope as in the scalar sampler above
+            const auto tau = simd::add(one, simd::sqrt(simd::fmadd(simd::mul(kappa, kappa), simd::set1(4.0), one)));
+            const auto root = simd::add(tau, simd::sqrt(simd::mul(two, tau)));
+            const auto rho = simd::div(simd::mul(two, kappa), root);
+            const auto rho_sq = simd::fmadd(rho, rho, one);
+            const auto kappa_r = simd::mul(simd::mul(rho_sq, root), simd::set1(0.25));
+
+            auto deviation = zero;
+            auto pending = simd::greater(one, zero);
+            while (simd::movemask(pending) != 0) {
+                rng.fill(std::span<T> { uniforms, 3 * simd::lanes });
+
+                auto cos_a = zero;
+                const auto sin_a = simd::sincos(&cos_a, simd::mul(half_pi, simd::load(uniforms)));
+                const auto z = simd::sub(simd::mul(cos_a, cos_a), simd::mul(sin_a, sin_a));
+                const auto f = simd::div(simd::fmadd(rho_sq, z, simd::mul(two, rho)), simd::fmadd(simd::mul(two, rho), z, rho_sq));
+                const auto c = simd::sub(kappa_r, simd::mul(kappa, f));
+
+                const auto envelope = simd::mul(c, simd::exp(simd::sub(one, c)));
+                const auto accepted = simd::mask_and(pending, simd::greater(envelope, simd::load(uniforms + simd::lanes)));
+
+                auto theta = simd::atan2(simd::mul(sin_a, simd::sub(one, rho)), simd::mul(cos_a, simd::add(one, rho)));
+                theta = simd::add(theta, theta);
+                theta = simd::sub(theta, simd::select(simd::greater(half_one, simd::load(uniforms + 2 * simd::lanes)), simd::add(theta, theta)));
+
+                // Lanes which are still pending hold a zero deviation, so adding the accepted ones fills them in
+                deviation = simd::add(deviation, simd::select(accepted, theta));
+                pending = simd::mask_andnot(pending, accepted);
+            }
+
+            // Wrap phi + deviation from (-2PI, 2PI) onto [0, 2PI). Rounding may still land on 2PI itself, which is mapped onto 0.
+            auto angles = simd::add(phi, deviation);
+            angles = simd::add(angles, simd::select(simd::greater(zero, angles), two_pi));
+            const auto proposals = lattice.propose(simd::select(simd::greater(two_pi, angles), angles));
+
+            const auto changes = lattice.changes(sites, proposals);
+            chg_energy = simd::accumulate(chg_energy, changes.energy);
+            chg_helicity_modulus = simd::accumulate(chg_helicity_modulus, changes.helicity_modulus);
+            chg_magnet_cos = simd::accumulate(chg_magnet_cos, changes.magnet_cos);
+            chg_magnet_sin = simd::accumulate(chg_magnet_sin, changes.magnet_sin);
+
+            lattice.set(sites, proposals, all);
+        }
+    }
+
+    return {
+        utils::mm256_reduce_add_pd(chg_energy), utils::mm256_reduce_add_pd(chg_helicity_modulus),
+        {utils::mm256_reduce_add_pd(chg_magnet_cos), utils::mm256_reduce_add_pd(chg_magnet_sin)}
+    };
+}
+
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::heat_bath(BasicLattice<float> & lattice, utils::SimdXoshiro256Plus & rng) noexcept;
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::heat_bath(BasicLattice<double> & lattice, utils::SimdXoshiro256Plus & rng) noexcept;
+
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::heat_bath_checkerboard(BasicLattice<float> & lattice, utils::SimdXoshiro256Plus & rng) noexcept;
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::heat_bath_checkerboard(BasicLattice<double> & lattice, utils::SimdXoshiro256Plus & rng) noexcept;
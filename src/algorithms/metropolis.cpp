@@ -1,3 +1,9 @@
+#include <bit>
+#include <cassert>
+#include <simde/x86/avx2.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
 #include "algorithms/metropolis.hpp"
 
 /**
@@ -9,31 +15,216 @@
  * @brief Performs a single Metropolis-Hastings sweep over the given lattice.
  *
  * @param lattice The lattice over which the sweep should be made.
- * @param rng The random number generator to use for the acceptance probability.
- * @return The total change of energy and magnetization once every lattice site is visited.
+ * @param rng The random number generator to use for the proposed angles and the acceptance probability.
+ * @param width The width of the window around the current angle new angles are proposed from. A width of 2PI proposes a
+ * completely new angle.
+ * @return The total change of energy and magnetization once every lattice site is visited and the number of accepted
+ * proposals.
  */
-std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::metropolis(Lattice & lattice, XoshiroCpp::Xoshiro256Plus & rng) noexcept {
+template<typename T>
+std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> algorithms::XY_ISA::metropolis(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng, const double_t width) noexcept {
     // Prepares the result objects containing the total change of energy and magnetization
     double_t chg_energy = 0.0, chg_helicity_modulus = 0.0, chg_magnet_cos = 0.0, chg_magnet_sin = 0.0;
+    std::size_t accepted = 0;
+
+    // Draw the proposed angle and the acceptance threshold of every site up front
+    const auto uniforms = rng.uniforms<double_t>(2 * lattice.num_sites());
 
     // Go over all lattice sites and propose a new angle for the spin at the site
     for (std::size_t i = 0; i < lattice.num_sites(); ++i) {
-        const auto angle = XoshiroCpp::DoubleFromBits(rng()) * N_PI<2>;
+        const auto proposal = width < N_PI<2> ? lattice.displace(i, width * (uniforms[2 * i] - 0.5)) : lattice.propose(uniforms[2 * i] * N_PI<2>);
 
         // Calculate the difference the proposed angle would make
-        const auto energy_diff = lattice.energy_diff(i, angle);
-        const auto helicity_modulus_diff = lattice.helicity_modulus_diff(i, angle);
-        const auto [magnet_cos_diff, magnet_sin_diff] = lattice.magnetization_diff(i, angle);
+        const auto changes = lattice.changes(i, proposal);
 
         // Check acceptance probability min(1.0, -exp{-BETA * H}) and update lattice site / results
-        if (lattice.acceptance(energy_diff) > XoshiroCpp::DoubleFromBits(rng())) {
-            chg_energy += energy_diff;
-            chg_helicity_modulus += helicity_modulus_diff;
-            chg_magnet_cos += magnet_cos_diff;
-            chg_magnet_sin += magnet_sin_diff;
-            lattice.set(i, angle);
+        if (lattice.acceptance(changes.energy) > uniforms[2 * i + 1]) {
+            chg_energy += changes.energy;
+            chg_helicity_modulus += changes.helicity_modulus;
+            chg_magnet_cos += changes.magnet_cos;
+            chg_magnet_sin += changes.magnet_sin;
+            lattice.set(i, proposal);
+            accepted++;
         }
     }
 
-    return {chg_energy, chg_helicity_modulus, {chg_magnet_cos, chg_magnet_sin}};
+    return {chg_energy, chg_helicity_modulus, {chg_magnet_cos, chg_magnet_sin}, accepted};
+}
+
+/**
+ * Performs the Metropolis-Hastings updates of a contiguous range of one sublattice. Sites of the same sublattice do not
+ * interact with each other, so a whole register of them (four doubles or eight floats) can be proposed, accepted or
+ * rejected and updated at once without changing the stationary distribution. The accept/reject decision is made for all
+ * lanes by a single comparison and only the accepted lanes are written back to the lattice. The changes of the
+ * observables are widened and accumulated in double precision.
+ *
+ * @param lattice The lattice to update
+ * @param uniforms Two registers of uniforms per register of sites, starting with the ones of the first site of the range
+ * @param color The sublattice (0 or 1)
+ * @param begin The first site of the range within the sublattice. Must be a multiple of the register width.
+ * @param end The end of the range within the sublattice. Must be a multiple of the register width.
+ * @param width The width of the window around the current angles new angles are proposed from.
+ * @return The total change of energy and magnetization over the range and the number of accepted proposals.
+ */
+template<typename T>
+static std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> metropolis_sublattice(BasicLattice<T> & lattice, const T * uniforms, const std::size_t color, const std::size_t begin, const std::size_t end, const double_t width) noexcept {
+    using simd = utils::simd<T>;
+
+    // Prepares the result vectors containing the total change of energy and magnetization per lane
+    simde__m256d chg_energy = simde_mm256_setzero_pd(), chg_helicity_modulus = simde_mm256_setzero_pd();
+    simde__m256d chg_magnet_cos = simde_mm256_setzero_pd(), chg_magnet_sin = simde_mm256_setzero_pd();
+
+    const auto two_pi = simd::set1(static_cast<T>(algorithms::N_PI<2>));
+    const auto window = simd::set1(static_cast<T>(width)), half_one = simd::set1(static_cast<T>(0.5));
+    const auto uniform = width >= algorithms::N_PI<2>;
+    std::size_t accepted = 0;
+
+    // Go over the range in groups of one register and propose a new angle for each of the sites. Each register of sites
+    // consumes one register of angles followed by one register of thresholds.
+    for (std::size_t k = begin; k < end; k += simd::lanes) {
+        const auto sites = lattice.sublattice_sites(color, k);
+        const auto offset = 2 * (k - begin);
+        const auto u = simd::load(uniforms + offset);
+        const auto proposals = uniform ? lattice.propose(simd::mul(u, two_pi)) : lattice.displace(sites, simd::mul(window, simd::sub(u, half_one)));
+
+        // Calculate the difference the proposed angles would make
+        const auto changes = lattice.changes(sites, proposals);
+
+        // Check acceptance probability min(1.0, -exp{-BETA * H}) for all lanes and only keep the accepted ones
+        const auto mask = simd::greater(lattice.acceptance(changes.energy), simd::load(uniforms + offset + simd::lanes));
+        chg_energy = simd::accumulate(chg_energy, simd::select(mask, changes.energy));
+        chg_helicity_modulus = simd::accumulate(chg_helicity_modulus, simd::select(mask, changes.helicity_modulus));
+        chg_magnet_cos = simd::accumulate(chg_magnet_cos, simd::select(mask, changes.magnet_cos));
+        chg_magnet_sin = simd::accumulate(chg_magnet_sin, simd::select(mask, changes.magnet_sin));
+
+        const auto lanes = simd::movemask(mask);
+        lattice.set(sites, proposals, lanes);
+        accepted += std::popcount(static_cast<std::uint32_t>(lanes));
+    }
+
+    return {
+        utils::mm256_reduce_add_pd(chg_energy), utils::mm256_reduce_add_pd(chg_helicity_modulus),
+        {utils::mm256_reduce_add_pd(chg_magnet_cos), utils::mm256_reduce_add_pd(chg_magnet_sin)}, accepted
+    };
+}
+
+/**
+ * Adds up the changes of two parts of a sweep.
+ */
+static std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> combine(const std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> & a, const std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> & b) noexcept {
+    return {
+        get<0>(a) + get<0>(b), get<1>(a) + get<1>(b),
+        {get<0>(get<2>(a)) + get<0>(get<2>(b)), get<1>(get<2>(a)) + get<1>(get<2>(b))}, get<3>(a) + get<3>(b)
+    };
+}
+
+/**
+ * @brief Performs a single Metropolis-Hastings sweep over the given lattice in checkerboard order.
+ *
+ * @param lattice The lattice over which the sweep should be made. Each sublattice must fill whole registers.
+ * @param rng The random number generator to use for the proposed angles and the acceptance probability.
+ * @param width The width of the window around the current angles new angles are proposed from.
+ * @return The total change of energy and magnetization once every lattice site is visited and the number of accepted
+ * proposals.
+ */
+template<typename T>
+std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> algorithms::XY_ISA::metropolis_checkerboard(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng, const double_t width) noexcept {
+    assert(lattice.num_sites() / 2 % utils::simd<T>::lanes == 0 && "Checkerboard sweeps require each sublattice to fill whole registers");
+    const auto half = lattice.num_sites() / 2;
+
+    // Draw the proposed angles and the acceptance thresholds of the whole sweep up front in the precision of the lattice
+    const auto uniforms = rng.uniforms<T>(2 * lattice.num_sites());
+
+    const auto first = metropolis_sublattice(lattice, uniforms.data(), 0, 0, half, width);
+    const auto second = metropolis_sublattice(lattice, uniforms.data() + 2 * half, 1, 0, half, width);
+    return combine(first, second);
 }
+
+/**
+ * Performs a single Metropolis-Hastings sweep over the given lattice in checkerboard order on multiple threads. Each
+ * sublattice is cut into one strip of rows per stream, which are updated in parallel since sites of the same sublattice
+ * never interact. Every strip draws from its own stream, so the sweep does not depend on which thread runs which strip.
+ *
+ * @param lattice The lattice over which the sweep should be made. Each sublattice must fill whole registers.
+ * @param streams One independent random number generator per strip
+ * @param width The width of the window around the current angles new angles are proposed from.
+ * @return The total change of energy and magnetization once every lattice site is visited and the number of accepted
+ * proposals.
+ */
+template<typename T>
+std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> algorithms::XY_ISA::metropolis_parallel(BasicLattice<T> & lattice, std::span<utils::SimdXoshiro256Plus> streams, const double_t width) noexcept {
+    using simd = utils::simd<T>;
+    assert(lattice.num_sites() / 2 % simd::lanes == 0 && "Checkerboard sweeps require each sublattice to fill whole registers");
+
+    // Strips are cut at register boundaries, so every strip is made of whole registers
+    const auto registers = lattice.num_sites() / 2 / simd::lanes;
+    const auto strips = streams.size();
+
+    std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> changes {};
+    for (std::size_t color = 0; color < 2; ++color) {
+        changes = combine(changes, tbb::parallel_reduce(tbb::blocked_range<std::size_t>(0, strips, 1), decltype(changes) {}, [&] (const tbb::blocked_range<std::size_t> & range, auto partial) {
+            for (auto strip = range.begin(); strip != range.end(); ++strip) {
+                const auto begin = strip * registers / strips * simd::lanes, end = (strip + 1) * registers / strips * simd::lanes;
+                const auto uniforms = streams[strip].template uniforms<T>(2 * (end - begin));
+                partial = combine(partial, metropolis_sublattice(lattice, uniforms.data(), color, begin, end, width));
+            }
+            return partial;
+        }, combine));
+    }
+    return changes;
+}
+
+/**
+ * Performs a single Metropolis-Hastings sweep over every replica of the batch at once. The sites are visited in order of
+ * the underlying vector just like the sequential sweep, but each register holds the same site of all replicas. The spins
+ * and neighbours of the site are therefore plain aligned loads and every lane proposes, accepts or rejects on its own,
+ * which makes each lane the exact sequential Markov chain of its replica.
+ *
+ * @brief Performs a single Metropolis-Hastings sweep over a batch of replicas.
+ *
+ * @param lattice The replicas over which the sweep should be made.
+ * @param rng The random number generator to use for the proposed angles and the acceptance probabilities.
+ * @return The total change of energy and magnetization of every replica once every lattice site is visited and the
+ * number of accepted proposals of every replica.
+ */
+std::tuple<BatchLattice::vector, BatchLattice::vector, std::tuple<BatchLattice::vector, BatchLattice::vector>, BatchLattice::vector> algorithms::XY_ISA::metropolis_batch(BatchLattice & lattice, utils::SimdXoshiro256Plus & rng) noexcept {
+    using simd = BatchLattice::simd;
+    constexpr auto lanes = BatchLattice::replicas;
+
+    // Prepares the result vectors containing the total change of energy and magnetization per replica
+    auto chg_energy = simd::zero(), chg_helicity_modulus = simd::zero(), chg_magnet_cos = simd::zero(), chg_magnet_sin = simd::zero();
+    auto accepted = simd::zero();
+    const auto two_pi = simd::set1(algorithms::N_PI<2>), one = simd::set1(1.0);
+
+    // Draw one register of angles followed by one register of thresholds per site up front
+    const auto uniforms = rng.uniforms<double_t>(2 * lanes * lattice.num_sites());
+
+    for (std::size_t i = 0; i < lattice.num_sites(); ++i) {
+        const auto proposals = lattice.propose(simd::mul(simd::load(uniforms.data() + 2 * lanes * i), two_pi));
+
+        // Calculate the difference the proposed angles would make in every replica
+        const auto energy_diff = lattice.energy_diff(i, proposals);
+        const auto helicity_modulus_diff = lattice.helicity_modulus_diff(i, proposals);
+        const auto [magnet_cos_diff, magnet_sin_diff] = lattice.magnetization_diff(i, proposals);
+
+        // Check acceptance probability min(1.0, -exp{-BETA * H}) for all replicas and only keep the accepted ones
+        const auto mask = simd::greater(lattice.acceptance(energy_diff), simd::load(uniforms.data() + 2 * lanes * i + lanes));
+        chg_energy = simd::add(chg_energy, simd::select(mask, energy_diff));
+        chg_helicity_modulus = simd::add(chg_helicity_modulus, simd::select(mask, helicity_modulus_diff));
+        chg_magnet_cos = simd::add(chg_magnet_cos, simd::select(mask, magnet_cos_diff));
+        chg_magnet_sin = simd::add(chg_magnet_sin, simd::select(mask, magnet_sin_diff));
+        accepted = simd::add(accepted, simd::select(mask, one));
+        lattice.set(i, proposals, mask);
+    }
+
+    return {chg_energy, chg_helicity_modulus, {chg_magnet_cos, chg_magnet_sin}, accepted};
+}
+
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> algorithms::XY_ISA::metropolis(BasicLattice<float> & lattice, utils::SimdXoshiro256Plus & rng, double_t width) noexcept;
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> algorithms::XY_ISA::metropolis(BasicLattice<double> & lattice, utils::SimdXoshiro256Plus & rng, double_t width) noexcept;
+
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> algorithms::XY_ISA::metropolis_checkerboard(BasicLattice<float> & lattice, utils::SimdXoshiro256Plus & rng, double_t width) noexcept;
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> algorithms::XY_ISA::metropolis_checkerboard(BasicLattice<double> & lattice, utils::SimdXoshiro256Plus & rng, double_t width) noexcept;
+
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> algorithms::XY_ISA::metropolis_parallel(BasicLattice<float> & lattice, std::span<utils::SimdXoshiro256Plus> streams, double_t width) noexcept;
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>, std::size_t> algorithms::XY_ISA::metropolis_parallel(BasicLattice<double> & lattice, std::span<utils::SimdXoshiro256Plus> streams, double_t width) noexcept;
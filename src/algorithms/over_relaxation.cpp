@@ -0,0 +1,86 @@
+#include <cassert>
+#include <simde/x86/avx2.h>
+
+#include "algorithms/over_relaxation.hpp"
+
+/**
+ * Performs a single over-relaxation sweep over the given lattice. A single sweep visits every lattice site in order of
+ * the underlying vector and reflects the spin at the site about the local field of its neighbours. The reflection keeps
+ * the energy constant and is always accepted, so the sweep needs neither random numbers nor an exponential. Combined
+ * with ergodic Metropolis sweeps it moves the spins through configuration space much faster near and below T_KT.
+ *
+ * @brief Performs a single over-relaxation sweep over the given lattice.
+ *
+ * @param lattice The lattice over which the sweep should be made.
+ * @return The total change of energy and magnetization once every lattice site is visited. The energy only changes by
+ * the rounding of the reflected angles.
+ */
+template<typename T>
+std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::over_relaxation(BasicLattice<T> & lattice) noexcept {
+    // Prepares the result objects containing the total change of energy and magnetization
+    double_t chg_energy = 0.0, chg_helicity_modulus = 0.0, chg_magnet_cos = 0.0, chg_magnet_sin = 0.0;
+
+    for (std::size_t i = 0; i < lattice.num_sites(); ++i) {
+        const auto reflected = lattice.reflect(i);
+
+        // The energy difference is kept, so the rolling energy stays exact despite rounding
+        const auto changes = lattice.changes(i, reflected);
+        chg_energy += changes.energy;
+        chg_helicity_modulus += changes.helicity_modulus;
+        chg_magnet_cos += changes.magnet_cos;
+        chg_magnet_sin += changes.magnet_sin;
+
+        lattice.set(i, reflected);
+    }
+
+    return {chg_energy, chg_helicity_modulus, {chg_magnet_cos, chg_magnet_sin}};
+}
+
+/**
+ * Performs a single over-relaxation sweep over the given lattice in checkerboard order. The local field of a site only
+ * depends on the other sublattice, so a whole register of sites of the same sublattice can be reflected at once.
+ *
+ * @brief Performs a single over-relaxation sweep over the given lattice in checkerboard order.
+ *
+ * @param lattice The lattice over which the sweep should be made. Each sublattice must fill whole registers.
+ * @return The total change of energy and magnetization once every lattice site is visited.
+ */
+template<typename T>
+std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::over_relaxation_checkerboard(BasicLattice<T> & lattice) noexcept {
+    using simd = utils::simd<T>;
+    assert(lattice.num_sites() / 2 % simd::lanes == 0 && "Checkerboard sweeps require each sublattice to fill whole registers");
+
+    // Prepares the result vectors containing the total change of energy and magnetization per lane
+    simde__m256d chg_energy = simde_mm256_setzero_pd(), chg_helicity_modulus = simde_mm256_setzero_pd();
+    simde__m256d chg_magnet_cos = simde_mm256_setzero_pd(), chg_magnet_sin = simde_mm256_setzero_pd();
+
+    // Every lane is accepted
+    constexpr auto all = static_cast<int32_t>((1ULL << simd::lanes) - 1);
+
+    const auto half = lattice.num_sites() / 2;
+    for (std::size_t color = 0; color < 2; ++color) {
+        for (std::size_t k = 0; k < half; k += simd::lanes) {
+            const auto sites = lattice.sublattice_sites(color, k);
+            const auto reflected = lattice.reflect(sites);
+
+            const auto changes = lattice.changes(sites, reflected);
+            chg_energy = simd::accumulate(chg_energy, changes.energy);
+            chg_helicity_modulus = simd::accumulate(chg_helicity_modulus, changes.helicity_modulus);
+            chg_magnet_cos = simd::accumulate(chg_magnet_cos, changes.magnet_cos);
+            chg_magnet_sin = simd::accumulate(chg_magnet_sin, changes.magnet_sin);
+
+            lattice.set(sites, reflected, all);
+        }
+    }
+
+    return {
+        utils::mm256_reduce_add_pd(chg_energy), utils::mm256_reduce_add_pd(chg_helicity_modulus),
+        {utils::mm256_reduce_add_pd(chg_magnet_cos), utils::mm256_reduce_add_pd(chg_magnet_sin)}
+    };
+}
+
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::over_relaxation(BasicLattice<float> & lattice) noexcept;
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::over_relaxation(BasicLattice<double> & lattice) noexcept;
+
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::over_relaxation_checkerboard(BasicLattice<float> & lattice) noexcept;
+template std::tuple<double_t, double_t, std::tuple<double_t, double_t>> algorithms::XY_ISA::over_relaxation_checkerboard(BasicLattice<double> & lattice) noexcept;
@@ -0,0 +1,84 @@
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <tbb/parallel_for.h>
+
+#include "algorithms/replica_exchange.hpp"
+
+algorithms::ReplicaExchange::ReplicaExchange(const std::size_t length, const std::vector<double_t> & temperatures, const std::vector<std::optional<std::vector<double_t>>> & spins, const Options & options)
+	: num_sites(length * length), slots(temperatures.size()) {
+	for (std::size_t i = 0; i < temperatures.size(); ++i) {
+		betas.push_back(1.0 / temperatures[i]);
+		replicas.push_back(make_simulator(length, betas[i], spins[i], options));
+	}
+	std::iota(slots.begin(), slots.end(), 0);
+}
+
+/**
+ * Forwards the measurements of a replica to the sink of its current temperature and remembers the last energy, which
+ * the exchanges are decided with.
+ */
+class ExchangeSink final : public observables::Sink {
+public:
+	explicit ExchangeSink(observables::Sink & sink) : sink(sink) {
+
+	}
+
+	void push(const observables::Type type, const double_t value) override {
+		if (type == observables::Energy) energy = value;
+		sink.push(type, value);
+	}
+
+	observables::Sink & sink;
+	double_t energy = 0.0;
+};
+
+void algorithms::ReplicaExchange::simulate(XoshiroCpp::Xoshiro256Plus & rng, const std::size_t sweeps, const std::size_t interval, const Algorithm algorithm, const std::span<observables::Sink *> sinks) {
+	assert(sinks.size() == replicas.size() && "Every temperature requires its own sink");
+
+	// Every replica draws from its own generator, which is 2^192 draws apart from the next one. The runs are started
+	// once, so the exchange intervals only advance them.
+	std::vector<XoshiroCpp::Xoshiro256Plus> generators;
+	for (std::size_t i = 0; i < replicas.size(); ++i) {
+		generators.push_back(rng);
+		rng.longJump();
+	}
+
+	tbb::parallel_for(std::size_t { 0 }, replicas.size(), [&] (const std::size_t i) {
+		replicas[i]->start(generators[i], algorithm);
+	});
+
+	std::vector<ExchangeSink> temperatures;
+	for (const auto sink : sinks) temperatures.emplace_back(*sink);
+	std::vector<double_t> energies (replicas.size());
+
+	for (std::size_t done = 0, round = 0; done < sweeps; ++round) {
+		const auto step = std::min(std::max<std::size_t>(interval, 1), sweeps - done);
+
+		// The replicas do not interact between two exchanges
+		tbb::parallel_for(std::size_t { 0 }, replicas.size(), [&] (const std::size_t t) {
+			replicas[slots[t]]->advance(step, temperatures[t]);
+			energies[t] = temperatures[t].energy * static_cast<double_t>(num_sites);
+		});
+		done += step;
+
+		// Swap the replicas of two neighbouring temperatures with P = min{1, exp{(beta_i - beta_j) * (E_i - E_j)}}
+		for (auto t = round % 2; t + 1 < replicas.size(); t += 2) {
+			attempted_swaps++;
+			if (const auto exponent = (betas[t] - betas[t + 1]) * (energies[t] - energies[t + 1]); exponent >= 0.0 || XoshiroCpp::DoubleFromBits(rng()) < std::exp(exponent)) {
+				std::swap(slots[t], slots[t + 1]);
+				replicas[slots[t]]->set_beta(betas[t]);
+				replicas[slots[t + 1]]->set_beta(betas[t + 1]);
+				accepted_swaps++;
+			}
+		}
+	}
+}
+
+algorithms::Simulator & algorithms::ReplicaExchange::replica(const std::size_t temperature) const {
+	return *replicas[slots[temperature]];
+}
+
+double_t algorithms::ReplicaExchange::swap_acceptance() const noexcept {
+	return attempted_swaps > 0 ? static_cast<double_t>(accepted_swaps) / static_cast<double_t>(attempted_swaps) : 0.0;
+}
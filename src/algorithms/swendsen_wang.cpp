@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cmath>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include "algorithms/swendsen_wang.hpp"
+
+/**
+ * Follows the parents of a site up to the root of its cluster. Halving the path on the way keeps the trees flat.
+ */
+static std::uint32_t find(std::vector<std::uint32_t> & parents, std::uint32_t i) noexcept {
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+/**
+ * Merges the clusters of two sites. The smaller root becomes the root of both, so the labels do not depend on the order
+ * in which the bonds are visited.
+ */
+static void unite(std::vector<std::uint32_t> & parents, const std::uint32_t i, const std::uint32_t j) noexcept {
+    const auto root_i = find(parents, i), root_j = find(parents, j);
+    if (root_i < root_j) parents[root_j] = root_i;
+    else if (root_j < root_i) parents[root_i] = root_j;
+}
+
+/**
+ * @brief Performs a single Swendsen-Wang sweep over the given lattice.
+ *
+ * Every bond is activated with P = 1 - exp{min{0.0, -2*BETA*(ox*r)*(oy*r)}} against one random reflection axis r and
+ * each of the resulting clusters is reflected about r with probability one half. The rows of the lattice are split into
+ * one strip per thread, which label their clusters independently. Only the bonds between two strips are merged
+ * sequentially afterwards, which is one row of bonds per strip.
+ *
+ * @param lattice The lattice over which the sweep should be made.
+ * @param rng The random number generator to use for the reflection axis, the bonds and the cluster flips.
+ * @param forest The workspace to label the clusters in.
+ */
+template<typename T>
+void algorithms::XY_ISA::swendsen_wang(BasicLattice<T> & lattice, utils::SimdXoshiro256Plus & rng, ClusterForest & forest) noexcept {
+    const auto length = lattice.side_length(), num_sites = lattice.num_sites();
+    const auto reference_angle = rng.next() * N_PI<2>;
+    const auto factor = -2.0 * lattice.get_beta();
+
+    auto & parents = forest.parents;
+    auto & projections = forest.projections;
+
+    // Project every spin onto the reflection axis and start with every site in its own cluster
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, num_sites), [&] (const tbb::blocked_range<std::size_t> & range) {
+        for (auto i = range.begin(); i != range.end(); ++i) {
+            projections[i] = std::cos(lattice[i] - reference_angle);
+            parents[i] = static_cast<std::uint32_t>(i);
+        }
+    });
+
+    // Each site owns the bond to its right and the bond below it, which consume one uniform each
+    const auto bonds = rng.uniforms<double_t>(2 * num_sites);
+    const auto active = [&] (const std::size_t i, const std::size_t j, const double_t u) {
+        return 1.0 - std::exp(std::min(0.0, factor * projections[i] * projections[j])) > u;
+    };
+
+    // Label the clusters of each strip of rows on its own. The bonds below the last row of a strip are left for later.
+    const auto strips = std::clamp<std::size_t>(tbb::this_task_arena::max_concurrency(), 1, length);
+    tbb::parallel_for(std::size_t { 0 }, strips, [&] (const std::size_t strip) {
+        const auto first_row = strip * length / strips, last_row = (strip + 1) * length / strips;
+        for (auto row = first_row; row < last_row; ++row) {
+            for (std::size_t i = row * length; i < (row + 1) * length; ++i) {
+                if (const auto j = lattice.neighbour(i, LatticeBase::RIGHT); active(i, j, bonds[2 * i])) {
+                    unite(parents, static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j));
+                }
+                if (const auto j = lattice.neighbour(i, LatticeBase::DOWN); row + 1 < last_row && active(i, j, bonds[2 * i + 1])) {
+                    unite(parents, static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j));
+                }
+            }
+        }
+    });
+
+    // Merge the clusters across the boundaries of the strips, including the periodic one
+    for (std::size_t strip = 0; strip < strips; ++strip) {
+        const auto row = (strip + 1) * length / strips - 1;
+        for (std::size_t i = row * length; i < (row + 1) * length; ++i) {
+            if (const auto j = lattice.neighbour(i, LatticeBase::DOWN); active(i, j, bonds[2 * i + 1])) {
+                unite(parents, static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j));
+            }
+        }
+    }
+
+    // Reflect every cluster whose root drew a flip. Finding the roots only reads the forest, so the sites are independent.
+    const auto flips = rng.uniforms<double_t>(num_sites);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, num_sites), [&] (const tbb::blocked_range<std::size_t> & range) {
+        for (auto i = range.begin(); i != range.end(); ++i) {
+            auto root = parents[i];
+            while (parents[root] != root) root = parents[root];
+
+            // Negating the parameters, adding PI and performing a mod 2PI maps the atan2 output domain [-PI, PI] to [0, 2PI)
+            if (flips[root] < 0.5) {
+                lattice.set(i, lattice.propose(std::fmod(algorithms::N_PI<3> + 2.0 * reference_angle - lattice[i], algorithms::N_PI<2>)));
+            }
+        }
+    });
+}
+
+template void algorithms::XY_ISA::swendsen_wang(BasicLattice<float> & lattice, utils::SimdXoshiro256Plus & rng, ClusterForest & forest) noexcept;
+template void algorithms::XY_ISA::swendsen_wang(BasicLattice<double> & lattice, utils::SimdXoshiro256Plus & rng, ClusterForest & forest) noexcept;
@@ -6,54 +6,125 @@
 #include <complex>
 #include <numeric>
 #include <fftw3.h>
+#include <iostream>
 #include <mutex>
 #include <ranges>
+#include <unordered_map>
 
-static std::mutex ftw_planning_mutex;
+/**
+ * The FFTW plans of every transform length used so far. Only the planning and the wisdom of FFTW have to be guarded,
+ * executing a plan on new arrays is thread-safe, so the plans are made once per length and then shared by all threads.
+ */
+class PlanCache {
+public:
+	/// A real-to-complex plan and its inverse for one transform length
+	struct Plans {
+		fftw_plan forward;
+		fftw_plan backward;
+	};
 
-static std::complex<double_t> fold(const std::complex<double_t> x) {
-	return x * std::conj(x);
-}
+	~PlanCache() {
+		for (const auto & [forward, backward] : plans | std::views::values) {
+			fftw_destroy_plan(forward);
+			fftw_destroy_plan(backward);
+		}
+	}
+
+	const Plans & get(const std::size_t length) {
+		std::lock_guard lock { mutex };
+		if (const auto it = plans.find(length); it != plans.end()) return it->second;
+
+		// Measuring overwrites the arrays, so the plans are made on scratch arrays with the alignment of the ones they run on
+		utils::aligned_vector<double_t> real (length);
+		utils::aligned_vector<std::complex<double_t>> spectrum (length / 2 + 1);
+		const auto forward = fftw_plan_dft_r2c_1d(static_cast<int>(length), real.data(), reinterpret_cast<fftw_complex*>(spectrum.data()), FFTW_MEASURE);
+		const auto backward = fftw_plan_dft_c2r_1d(static_cast<int>(length), reinterpret_cast<fftw_complex*>(spectrum.data()), real.data(), FFTW_MEASURE);
+		return plans.emplace(length, Plans { forward, backward }).first->second;
+	}
 
-static void discrete_fourier_transform(utils::aligned_vector<std::complex<double_t>> & in, utils::aligned_vector<std::complex<double_t>> & out, const int direction) {
-	assert(in.size() == out.size() && "Input and output vectors must be of same size");
+	void import_wisdom(const std::filesystem::path & path) {
+		std::lock_guard lock { mutex };
+		if (std::filesystem::exists(path) && !fftw_import_wisdom_from_filename(path.c_str())) {
+			std::cerr << "[FFTW] Could not import wisdom from " << path << std::endl;
+		}
+	}
 
-	std::unique_lock lock {ftw_planning_mutex};
-	const auto plan = fftw_plan_dft_1d(static_cast<int>(in.size()), reinterpret_cast<fftw_complex*>(in.data()), reinterpret_cast<fftw_complex*>(out.data()), direction, FFTW_ESTIMATE);
-	lock.unlock();
+	void export_wisdom(const std::filesystem::path & path) {
+		std::lock_guard lock { mutex };
+		std::filesystem::create_directories(path.parent_path());
+		if (!fftw_export_wisdom_to_filename(path.c_str())) {
+			std::cerr << "[FFTW] Could not export wisdom to " << path << std::endl;
+		}
+	}
 
-	fftw_execute_dft(plan, reinterpret_cast<fftw_complex*>(in.data()), reinterpret_cast<fftw_complex*>(out.data()));
+private:
+	std::mutex mutex;
+	std::unordered_map<std::size_t, Plans> plans;
+};
+
+static PlanCache plan_cache;
+
+static std::complex<double_t> fold(const std::complex<double_t> x) {
+	return x * std::conj(x);
+}
 
-	lock.lock();
-	fftw_destroy_plan(plan);
-	lock.unlock();
+/**
+ * @return The smallest length of at least twice the given one whose only prime factors are 2, 3, 5 and 7, which
+ * FFTW transforms fastest.
+ */
+static std::size_t padded_length(const std::size_t length) {
+	for (auto padded = 2 * length; ; ++padded) {
+		auto rest = padded;
+		for (const std::size_t factor : { 2, 3, 5, 7 }) {
+			while (rest % factor == 0) rest /= factor;
+		}
+		if (rest == 1) return padded;
+	}
 }
 
-std::vector<double_t> normalized_autocorrelation_function(const std::span<double_t> & data) {
+/**
+ * Transforms the time series zero-padded to at least twice its length, so the correlations do not wrap around the end
+ * of the series onto its beginning.
+ */
+std::vector<double_t> normalized_autocorrelation_function(const std::span<const double_t> & data, const double_t mean) {
 	assert(!data.empty() && "Input data must not be empty");
-	const auto mean = std::ranges::fold_left(data, 0.0, std::plus()) / static_cast<double_t>(data.size());
 
-	utils::aligned_vector<std::complex<double_t>> in (data.size()), out (data.size());
-	std::ranges::transform(data, in.begin(), [&] (const auto x) {
-		return std::complex<double_t>(x - mean, 0.0);
+	const auto length = padded_length(data.size());
+	utils::aligned_vector<double_t> real (length, 0.0);
+	utils::aligned_vector<std::complex<double_t>> spectrum (length / 2 + 1);
+	std::ranges::transform(data, real.begin(), [&] (const auto x) {
+		return x - mean;
 	});
 
-	discrete_fourier_transform(in, out, FFTW_FORWARD);
-	std::ranges::transform(out, out.begin(), fold);
+	const auto & [forward, backward] = plan_cache.get(length);
+	fftw_execute_dft_r2c(forward, real.data(), reinterpret_cast<fftw_complex*>(spectrum.data()));
+	std::ranges::transform(spectrum, spectrum.begin(), fold);
 
-	discrete_fourier_transform(out, in, FFTW_BACKWARD);
-	const auto norm = 1.0 / in[0].real();
+	fftw_execute_dft_c2r(backward, reinterpret_cast<fftw_complex*>(spectrum.data()), real.data());
+	const auto norm = 1.0 / real[0];
 
-	std::vector<double_t> result (in.size());
-	std::ranges::transform(in, result.begin(), [&] (const auto c) {
-		return c.real() * norm;
+	std::vector<double_t> result (data.size());
+	std::ranges::transform(real.begin(), real.begin() + static_cast<std::ptrdiff_t>(data.size()), result.begin(), [&] (const auto x) {
+		return x * norm;
 	});
 
 	return result;
 }
 
-std::tuple<double_t, std::vector<double_t>> analysis::integrated_autocorrelation_time(const std::span<double_t> & data) {
-	const auto correlation = normalized_autocorrelation_function(data);
+void analysis::load_wisdom(const std::filesystem::path & path) {
+	plan_cache.import_wisdom(path);
+}
+
+void analysis::save_wisdom(const std::filesystem::path & path) {
+	plan_cache.export_wisdom(path);
+}
+
+std::tuple<double_t, std::vector<double_t>> analysis::integrated_autocorrelation_time(const std::span<const double_t> & data) {
+	return integrated_autocorrelation_time(data, std::ranges::fold_left(data, 0.0, std::plus()) / static_cast<double_t>(data.size()));
+}
+
+std::tuple<double_t, std::vector<double_t>> analysis::integrated_autocorrelation_time(const std::span<const double_t> & data, const double_t mean) {
+	const auto correlation = normalized_autocorrelation_function(data, mean);
 	const auto positive = correlation | std::ranges::views::take_while([] (const double_t x) {
 		return x > 0.0;
 	});
@@ -61,3 +132,22 @@ std::tuple<double_t, std::vector<double_t>> analysis::integrated_autocorrelation
 	const auto tau = 0.5 + std::ranges::fold_left(positive | std::ranges::views::drop(1), 0.0, std::plus());
 	return {tau, std::ranges::to<std::vector>(positive) };
 }
+
+std::tuple<double_t, std::vector<double_t>> analysis::integrated_autocorrelation_time(const std::span<const std::tuple<std::size_t, double_t>> & correlation) {
+	assert(!correlation.empty() && get<0>(correlation.front()) == 0 && "The autocorrelation function must start at lag zero");
+
+	auto tau = 0.5;
+	std::vector<double_t> result { get<1>(correlation.front()) };
+	for (std::size_t i = 1; i < correlation.size() && get<1>(correlation[i]) > 0.0; ++i) {
+		const auto [lag, value] = correlation[i];
+		const auto width = i + 1 < correlation.size() ? get<0>(correlation[i + 1]) - lag : lag - get<0>(correlation[i - 1]);
+		tau += value * static_cast<double_t>(width);
+
+		// Fill in the lags skipped since the previous one by linear interpolation
+		const auto [previous_lag, previous] = correlation[i - 1];
+		for (auto l = previous_lag + 1; l <= lag; ++l) {
+			result.push_back(previous + (value - previous) * static_cast<double_t>(l - previous_lag) / static_cast<double_t>(lag - previous_lag));
+		}
+	}
+	return { tau, result };
+}
@@ -1,10 +1,14 @@
 #include <algorithm>
+#include <array>
 #include <ranges>
 #include <cmath>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
 
 #include "analysis/boostrap.hpp"
+#include "algorithms/simulator.hpp"
 
-std::vector<double_t> blocking(const std::span<double_t> & data, const double_t tau) {
+std::vector<double_t> blocking(const std::span<const double_t> & data, const double_t tau) {
     const auto stride = static_cast<std::size_t>(std::ceil(tau));
 
     const auto num_chunks = static_cast<std::size_t>(std::ceil(static_cast<double_t>(data.size()) / static_cast<double_t>(stride)));
@@ -18,34 +22,227 @@ std::vector<double_t> blocking(const std::span<double_t> & data, const double_t
     return result;
 }
 
-std::span<double_t> thermalize(const std::span<double_t> & data, const double_t tau) {
+std::span<const double_t> thermalize(const std::span<const double_t> & data, const double_t tau) {
     const auto offset = 3 * static_cast<std::size_t>(std::ceil(tau));
     return data.subspan(offset, data.size() - offset);
 }
 
-std::vector<double_t> analysis::thermalize_and_block(const std::span<double_t> & data, const double_t tau, const bool skip_thermalization) {
+std::vector<double_t> analysis::thermalize_and_block(const std::span<const double_t> & data, const double_t tau, const bool skip_thermalization) {
     return blocking(skip_thermalization ? data : thermalize(data, tau), tau);
 }
 
-double_t sample_with_replacement(XoshiroCpp::Xoshiro256Plus & rng, const std::vector<double_t> & data) {
-    std::uniform_int_distribution<std::size_t> range {0, data.size() - 1 };
-    return std::ranges::fold_left(data, 0.0, [&] (const auto sum, const auto) {
-        return sum + data[range(rng)];
-    }) / static_cast<double_t>(data.size());
+/// The number of resamples drawn from one generator, which is the unit of work spread over the threads
+static constexpr std::size_t RESAMPLES_PER_BATCH = 1024;
+
+/// The number of batches drawn between two checks whether the estimates have converged
+static constexpr std::size_t BATCHES_PER_ROUND = 16;
+
+// The resampling kernels of the instruction sets. Each of them is compiled from resample.cpp with its own instruction set.
+namespace analysis::sse2 {
+    std::array<double_t, 4> resample(XoshiroCpp::Xoshiro256Plus & rng, std::span<const double_t> blocked, std::size_t resamples, double_t shift) noexcept;
+    void resample_means(XoshiroCpp::Xoshiro256Plus & rng, std::span<const std::span<const double_t>> columns, std::size_t resamples, std::span<double_t> means) noexcept;
 }
 
-std::tuple<double_t, double_t> analysis::bootstrap_blocked(XoshiroCpp::Xoshiro256Plus & rng, const std::vector<double_t> & blocked, const std::size_t n) {
-    std::vector<double_t> resamples (n);
-    std::ranges::generate(resamples, [&] {
-        return sample_with_replacement(rng, blocked);
-    });
+namespace analysis::avx2 {
+    std::array<double_t, 4> resample(XoshiroCpp::Xoshiro256Plus & rng, std::span<const double_t> blocked, std::size_t resamples, double_t shift) noexcept;
+    void resample_means(XoshiroCpp::Xoshiro256Plus & rng, std::span<const std::span<const double_t>> columns, std::size_t resamples, std::span<double_t> means) noexcept;
+}
+
+namespace analysis::avx512 {
+    std::array<double_t, 4> resample(XoshiroCpp::Xoshiro256Plus & rng, std::span<const double_t> blocked, std::size_t resamples, double_t shift) noexcept;
+    void resample_means(XoshiroCpp::Xoshiro256Plus & rng, std::span<const std::span<const double_t>> columns, std::size_t resamples, std::span<double_t> means) noexcept;
+}
+
+static std::array<double_t, 4> resample(XoshiroCpp::Xoshiro256Plus & rng, const std::span<const double_t> blocked, const std::size_t resamples, const double_t shift) noexcept {
+    static const auto isa = algorithms::detect_isa();
+    switch (isa) {
+        case algorithms::AVX512: return analysis::avx512::resample(rng, blocked, resamples, shift);
+        case algorithms::AVX2: return analysis::avx2::resample(rng, blocked, resamples, shift);
+        default: return analysis::sse2::resample(rng, blocked, resamples, shift);
+    }
+}
+
+static void resample_means(XoshiroCpp::Xoshiro256Plus & rng, const std::span<const std::span<const double_t>> columns, const std::size_t resamples, const std::span<double_t> means) noexcept {
+    static const auto isa = algorithms::detect_isa();
+    switch (isa) {
+        case algorithms::AVX512: return analysis::avx512::resample_means(rng, columns, resamples, means);
+        case algorithms::AVX2: return analysis::avx2::resample_means(rng, columns, resamples, means);
+        default: return analysis::sse2::resample_means(rng, columns, resamples, means);
+    }
+}
+
+/**
+ * Checks whether the standard deviation of an estimate is known to the given relative tolerance. The standard error of
+ * the sample variance follows from the fourth central moment of the resamples, which makes the check hold for skewed
+ * and heavy-tailed estimates such as the specific heat near the transition as well.
+ *
+ * @param sums The sums of the first four powers of the shifted values of the estimate
+ * @param n The number of resamples
+ */
+static bool converged(const std::span<const double_t> sums, const std::size_t n, const double_t tolerance) {
+    const auto count = static_cast<double_t>(n);
+    const auto mean = sums[0] / count;
+    const auto m2 = sums[1] / count - mean * mean;
+    const auto m4 = sums[3] / count - 4.0 * mean * sums[2] / count + 6.0 * mean * mean * sums[1] / count - 3.0 * std::pow(mean, 4.0);
+    if (m2 <= 0.0) return true;
 
+    // The relative standard error of the standard deviation is half the one of the variance
+    const auto variance_error = std::sqrt(std::max(m4 - m2 * m2 * (count - 3.0) / (count - 1.0), 0.0) / count);
+    return variance_error / (2.0 * m2 * count / (count - 1.0)) <= tolerance;
+}
+
+/**
+ * Draws batches of resamples until every estimate has converged to the given tolerance or the maximum number of
+ * resamples is reached. Every batch draws from its own generator, one long jump apart from the previous one, and the
+ * batches of a round are reduced deterministically, so the estimates only depend on the seed and not on how the
+ * batches are spread over the threads.
+ *
+ * @param estimates The number of estimates
+ * @param n The maximum number of resamples
+ * @param tolerance The relative standard error the standard deviation of every estimate has to reach, or 0 to always
+ * draw the maximum number of resamples
+ * @param accumulate Draws the given number of resamples from the generator and adds the first four powers of every
+ * shifted estimate of every resample to the given sums, four per estimate
+ * @return The sums of the powers of every estimate and the number of resamples drawn.
+ */
+template<typename F>
+static std::tuple<std::vector<double_t>, std::size_t> draw(XoshiroCpp::Xoshiro256Plus & rng, const std::size_t estimates, const std::size_t n, const double_t tolerance, F && accumulate) {
+    std::vector<double_t> totals (4 * estimates);
+    std::size_t drawn = 0;
+
+    while (drawn < n) {
+        std::vector<std::tuple<XoshiroCpp::Xoshiro256Plus, std::size_t>> batches;
+        for (std::size_t i = 0; i < BATCHES_PER_ROUND && drawn < n; ++i) {
+            const auto resamples = std::min(RESAMPLES_PER_BATCH, n - drawn);
+            batches.emplace_back(rng, resamples);
+            rng.longJump();
+            drawn += resamples;
+        }
+
+        const auto sums = tbb::parallel_deterministic_reduce(tbb::blocked_range<std::size_t> { 0, batches.size(), 1 }, std::vector<double_t>(4 * estimates),
+            [&] (const tbb::blocked_range<std::size_t> & range, std::vector<double_t> partial) {
+                for (auto i = range.begin(); i != range.end(); ++i) {
+                    auto & [generator, resamples] = batches[i];
+                    accumulate(generator, resamples, std::span { partial });
+                }
+                return partial;
+            }, [] (std::vector<double_t> a, const std::vector<double_t> & b) {
+                std::ranges::transform(a, b, a.begin(), std::plus());
+                return a;
+            });
+        std::ranges::transform(totals, sums, totals.begin(), std::plus());
+
+        if (tolerance <= 0.0) continue;
+        if (std::ranges::all_of(std::views::iota(std::size_t { 0 }, estimates), [&] (const auto k) { return converged(std::span { totals }.subspan(4 * k, 4), drawn, tolerance); })) break;
+    }
+    return { totals, drawn };
+}
+
+/**
+ * @return The standard deviation of an estimate from the sums of the powers of its shifted values.
+ */
+static double_t standard_deviation(const std::span<const double_t> sums, const std::size_t n) {
+    const auto resamples = static_cast<double_t>(n);
+    return std::sqrt((sums[1] - sums[0] * sums[0] / resamples) / (resamples - 1.0));
+}
+
+/// Adds the first four powers of a shifted value to the given sums
+static void add_powers(const std::span<double_t> sums, const double_t shifted) {
+    const auto square = shifted * shifted;
+    sums[0] += shifted;
+    sums[1] += square;
+    sums[2] += square * shifted;
+    sums[3] += square * square;
+}
+
+std::tuple<double_t, double_t, std::size_t> analysis::bootstrap_blocked(XoshiroCpp::Xoshiro256Plus & rng, const std::vector<double_t> & blocked, const std::size_t n, const double_t tolerance) {
     const auto mean = std::ranges::fold_left(blocked, 0.0, std::plus()) / static_cast<double_t>(blocked.size());
-    const auto tmp = std::ranges::fold_left(resamples, 0.0, std::plus()) / static_cast<double_t>(resamples.size());
 
-    const auto variance = std::ranges::fold_left(resamples, 0.0, [&] (const auto sum, const auto x) {
-        return sum + std::pow(tmp - x, 2.0);
-    } ) / static_cast<double_t>(resamples.size() - 1);
+    // The means of the resamples are summed up relative to the mean of the blocks, around which they scatter
+    const auto [sums, drawn] = draw(rng, 1, n, tolerance, [&] (XoshiroCpp::Xoshiro256Plus & generator, const std::size_t resamples, const std::span<double_t> partial) {
+        std::ranges::transform(partial, resample(generator, blocked, resamples, mean), partial.begin(), std::plus());
+    });
+
+    return { mean, standard_deviation(sums, drawn), drawn };
+}
+
+std::vector<std::vector<double_t>> analysis::align_blocks(const std::vector<std::span<const double_t>> & series) {
+    const auto bins = std::ranges::min(series | std::views::transform([] (const auto & x) { return x.size(); }));
+
+    std::vector<std::vector<double_t>> result;
+    result.reserve(2 * series.size());
+    for (const auto & blocks : series) {
+        std::vector<double_t> sums (bins), counts (bins);
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            const auto bin = i * bins / blocks.size();
+            sums[bin] += blocks[i];
+            counts[bin] += 1.0;
+        }
+
+        result.push_back(std::move(sums));
+        result.push_back(std::move(counts));
+    }
+    return result;
+}
+
+double_t analysis::derive(const observables::Type type, const double_t temperature, const double_t first, const double_t second) {
+    switch (type) {
+        case observables::SpecificHeat: return (second - first * first) / (temperature * temperature);
+        case observables::MagneticSusceptibility: return (second - first * first) / temperature;
+        default: return -second / 2.0 - first / temperature;
+    }
+}
+
+analysis::Estimates analysis::bootstrap_joint(XoshiroCpp::Xoshiro256Plus & rng, const std::map<observables::Type, std::vector<double_t>> & blocked, const double_t temperature, const std::size_t n, const double_t tolerance) {
+    std::vector<observables::Type> types;
+    std::vector<std::span<const double_t>> series;
+    std::vector<double_t> estimates;
+    for (const auto & [type, values] : blocked) {
+        types.push_back(type);
+        series.emplace_back(values);
+        estimates.push_back(std::ranges::fold_left(values, 0.0, std::plus()) / static_cast<double_t>(values.size()));
+    }
+
+    // The derived observables follow the measured ones, each one with the columns of the observables it is computed from
+    std::vector<std::tuple<observables::Type, std::size_t, std::size_t>> derived;
+    for (const auto & [type, first, second] : DERIVED) {
+        const auto a = std::ranges::find(types, first), b = std::ranges::find(types, second);
+        if (a == types.end() || b == types.end()) continue;
+
+        const auto i = static_cast<std::size_t>(a - types.begin()), j = static_cast<std::size_t>(b - types.begin());
+        derived.emplace_back(type, i, j);
+        estimates.push_back(derive(type, temperature, estimates[i], estimates[j]));
+    }
+
+    const auto aligned = align_blocks(series);
+    const std::vector<std::span<const double_t>> columns (aligned.begin(), aligned.end());
 
-    return {mean, std::sqrt(variance)};
+    // Every estimate is summed up relative to its value on the complete data, around which the resamples scatter
+    const auto [sums, drawn] = draw(rng, estimates.size(), n, tolerance, [&] (XoshiroCpp::Xoshiro256Plus & generator, const std::size_t resamples, const std::span<double_t> partial) {
+        std::vector<double_t> means (resamples * columns.size());
+        resample_means(generator, columns, resamples, means);
+
+        for (std::size_t r = 0; r < resamples; ++r) {
+            const auto row = std::span { means }.subspan(r * columns.size(), columns.size());
+            const auto mean = [&] (const std::size_t k) { return row[2 * k] / row[2 * k + 1]; };
+
+            for (std::size_t k = 0; k < estimates.size(); ++k) {
+                double_t value;
+                if (k < types.size()) {
+                    value = mean(k);
+                } else {
+                    const auto [type, a, b] = derived[k - types.size()];
+                    value = derive(type, temperature, mean(a), mean(b));
+                }
+                add_powers(partial.subspan(4 * k, 4), value - estimates[k]);
+            }
+        }
+    });
+
+    Estimates result;
+    for (std::size_t k = 0; k < estimates.size(); ++k) {
+        const auto type = k < types.size() ? types[k] : get<0>(derived[k - types.size()]);
+        result.emplace(type, std::tuple { estimates[k], standard_deviation(std::span { sums }.subspan(4 * k, 4), drawn), std::nullopt, drawn });
+    }
+    return result;
 }
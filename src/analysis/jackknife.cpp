@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "analysis/jackknife.hpp"
+
+/// The fewest bins the binning analysis goes down to, below which the standard error itself becomes too uncertain
+static constexpr std::size_t MIN_BINS = 32;
+
+/**
+ * Rejects time series too short for a jackknife. Leaving out the only bin leaves no blocks to average, so at least two
+ * are required. The binning analysis never merges below MIN_BINS bins, so only the blocks themselves can be too few.
+ */
+static void require_blocks(const std::size_t blocks) {
+    if (blocks < 2) {
+        throw std::invalid_argument("The jackknife needs at least 2 blocks, but got " + std::to_string(blocks));
+    }
+}
+
+/// The sum and the number of blocks of every bin of one observable
+struct Bins {
+    std::vector<double_t> sums, counts;
+};
+
+/**
+ * Merges neighbouring bins, which halves their number. An odd bin at the end is merged into the last one.
+ */
+static Bins merge(const Bins & bins) {
+    const auto size = bins.sums.size() / 2;
+
+    Bins result { std::vector<double_t>(size), std::vector<double_t>(size) };
+    for (std::size_t i = 0; i < bins.sums.size(); ++i) {
+        const auto bin = std::min(i / 2, size - 1);
+        result.sums[bin] += bins.sums[i];
+        result.counts[bin] += bins.counts[i];
+    }
+    return result;
+}
+
+/**
+ * @return The mean of all blocks when every bin in turn is left out.
+ */
+static std::vector<double_t> leave_one_out(const Bins & bins) {
+    const auto sum = std::reduce(bins.sums.begin(), bins.sums.end());
+    const auto count = std::reduce(bins.counts.begin(), bins.counts.end());
+
+    std::vector<double_t> result (bins.sums.size());
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        result[i] = (sum - bins.sums[i]) / (count - bins.counts[i]);
+    }
+    return result;
+}
+
+/**
+ * @return The jackknife standard deviation of an estimate from its values on every jackknife sample.
+ */
+static double_t jackknife_error(const std::span<const double_t> samples) {
+    const auto n = static_cast<double_t>(samples.size());
+    const auto mean = std::reduce(samples.begin(), samples.end()) / n;
+
+    double_t squares = 0.0;
+    for (const auto sample : samples) {
+        squares += (sample - mean) * (sample - mean);
+    }
+    return std::sqrt((n - 1.0) / n * squares);
+}
+
+/**
+ * Doubles the size of the bins until the standard error of the mean lies within the uncertainty of the standard error
+ * of the bins half as large, or until fewer than MIN_BINS bins would remain.
+ *
+ * @return The number of times the bins have to be merged.
+ */
+static std::size_t binning_level(Bins bins) {
+    std::size_t level = 0;
+    auto error = jackknife_error(leave_one_out(bins));
+
+    while (bins.sums.size() / 2 >= MIN_BINS) {
+        const auto n = static_cast<double_t>(bins.sums.size());
+        bins = merge(bins);
+
+        const auto next = jackknife_error(leave_one_out(bins));
+        if (next - error <= error / std::sqrt(2.0 * (n - 1.0))) break;
+
+        error = next;
+        level++;
+    }
+    return level;
+}
+
+std::tuple<double_t, double_t, std::size_t> analysis::jackknife_binned(const std::span<const double_t> blocked) {
+    require_blocks(blocked.size());
+
+    Bins bins { { blocked.begin(), blocked.end() }, std::vector<double_t>(blocked.size(), 1.0) };
+    const auto mean = std::reduce(blocked.begin(), blocked.end()) / static_cast<double_t>(blocked.size());
+
+    const auto level = binning_level(bins);
+    for (std::size_t i = 0; i < level; ++i) bins = merge(bins);
+
+    return { mean, jackknife_error(leave_one_out(bins)), std::size_t { 1 } << level };
+}
+
+analysis::Estimates analysis::jackknife_joint(const std::map<observables::Type, std::vector<double_t>> & blocked, const double_t temperature) {
+    std::vector<observables::Type> types;
+    std::vector<std::span<const double_t>> series;
+    for (const auto & [type, values] : blocked) {
+        types.push_back(type);
+        series.emplace_back(values);
+    }
+
+    for (const auto & values : series) require_blocks(values.size());
+
+    // All observables share the bins, so they are merged as often as the most strongly correlated one needs
+    const auto aligned = align_blocks(series);
+    std::vector<Bins> bins;
+    std::size_t level = 0;
+    for (std::size_t k = 0; k < types.size(); ++k) {
+        bins.push_back({ aligned[2 * k], aligned[2 * k + 1] });
+        level = std::max(level, binning_level(bins.back()));
+    }
+
+    std::vector<std::vector<double_t>> samples;
+    for (auto & bin : bins) {
+        for (std::size_t i = 0; i < level; ++i) bin = merge(bin);
+        samples.push_back(leave_one_out(bin));
+    }
+
+    // The bins of an observable with more blocks than the coarsest one hold proportionally more blocks
+    const auto bins_per_series = static_cast<double_t>(aligned.front().size());
+    const auto block_size = [&] (const std::size_t k) {
+        return static_cast<std::size_t>(std::round(static_cast<double_t>(std::size_t { 1 } << level) * static_cast<double_t>(series[k].size()) / bins_per_series));
+    };
+
+    Estimates result;
+    std::vector<double_t> means;
+    for (std::size_t k = 0; k < types.size(); ++k) {
+        means.push_back(std::reduce(series[k].begin(), series[k].end()) / static_cast<double_t>(series[k].size()));
+        result.emplace(types[k], std::tuple { means[k], jackknife_error(samples[k]), block_size(k), std::nullopt });
+    }
+
+    for (const auto & [type, first, second] : DERIVED) {
+        const auto a = std::ranges::find(types, first), b = std::ranges::find(types, second);
+        if (a == types.end() || b == types.end()) continue;
+
+        const auto i = static_cast<std::size_t>(a - types.begin()), j = static_cast<std::size_t>(b - types.begin());
+        std::vector<double_t> derived (samples[i].size());
+        for (std::size_t n = 0; n < derived.size(); ++n) {
+            derived[n] = derive(type, temperature, samples[i][n], samples[j][n]);
+        }
+        result.emplace(type, std::tuple { derive(type, temperature, means[i], means[j]), jackknife_error(derived), std::max(block_size(i), block_size(j)), std::nullopt });
+    }
+    return result;
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "analysis/resample.hpp"
+#include "utils/random.hpp"
+
+std::array<double_t, 4> analysis::XY_ISA::resample(XoshiroCpp::Xoshiro256Plus & rng, const std::span<const double_t> blocked, const std::size_t resamples, const double_t shift) noexcept {
+    using simd = utils::simd<double_t>;
+    assert(!blocked.empty() && blocked.size() <= static_cast<std::size_t>(std::numeric_limits<int32_t>::max()) && "The blocks must be addressable by 32-bit indices");
+
+    utils::SimdXoshiro256Plus streams { rng };
+    utils::aligned_vector<std::uint32_t> indices (blocked.size());
+    const auto norm = 1.0 / static_cast<double_t>(blocked.size());
+
+    std::array<double_t, 4> sums {};
+    for (std::size_t r = 0; r < resamples; ++r) {
+        streams.bounded(indices, static_cast<std::uint32_t>(blocked.size()));
+
+        std::size_t i = 0;
+        auto accumulator = simde_mm256_setzero_pd();
+        for (; i + simd::lanes <= blocked.size(); i += simd::lanes) {
+            const auto index = simd::load_index(reinterpret_cast<const int32_t *>(indices.data() + i));
+            accumulator = simd::accumulate(accumulator, simd::gather(blocked.data(), index));
+        }
+
+        auto total = utils::mm256_reduce_add_pd(accumulator);
+        for (; i < blocked.size(); ++i) {
+            total += blocked[indices[i]];
+        }
+
+        const auto mean = total * norm - shift;
+        const auto square = mean * mean;
+        sums[0] += mean;
+        sums[1] += square;
+        sums[2] += square * mean;
+        sums[3] += square * square;
+    }
+    return sums;
+}
+
+void analysis::XY_ISA::resample_means(XoshiroCpp::Xoshiro256Plus & rng, const std::span<const std::span<const double_t>> columns, const std::size_t resamples, const std::span<double_t> means) noexcept {
+    using simd = utils::simd<double_t>;
+    const auto blocks = columns.front().size();
+    assert(blocks > 0 && blocks <= static_cast<std::size_t>(std::numeric_limits<int32_t>::max()) && "The blocks must be addressable by 32-bit indices");
+    assert(std::ranges::all_of(columns, [&] (const auto & column) { return column.size() == blocks; }) && "All series must hold the same number of blocks");
+    assert(means.size() >= resamples * columns.size() && "There must be a mean for every series in every resample");
+
+    utils::SimdXoshiro256Plus streams { rng };
+    utils::aligned_vector<std::uint32_t> indices (blocks);
+    const auto norm = 1.0 / static_cast<double_t>(blocks);
+
+    for (std::size_t r = 0; r < resamples; ++r) {
+        streams.bounded(indices, static_cast<std::uint32_t>(blocks));
+
+        for (std::size_t c = 0; c < columns.size(); ++c) {
+            const auto column = columns[c];
+
+            std::size_t i = 0;
+            auto accumulator = simde_mm256_setzero_pd();
+            for (; i + simd::lanes <= blocks; i += simd::lanes) {
+                const auto index = simd::load_index(reinterpret_cast<const int32_t *>(indices.data() + i));
+                accumulator = simd::accumulate(accumulator, simd::gather(column.data(), index));
+            }
+
+            auto total = utils::mm256_reduce_add_pd(accumulator);
+            for (; i < blocks; ++i) {
+                total += column[indices[i]];
+            }
+            means[r * columns.size() + c] = total * norm;
+        }
+    }
+}
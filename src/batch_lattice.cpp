@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "batch_lattice.hpp"
+#include "algorithms/algorithms.hpp"
+
+BatchLattice::BatchLattice(const std::size_t length, const std::vector<double_t> & betas, const std::vector<std::optional<std::vector<double_t>>> & spins) : length(length),
+        spins(replicas * length * length), cosines(replicas * length * length), sines(replicas * length * length), neighbour_table(4 * length * length) {
+    assert(!betas.empty() && betas.size() <= replicas && "A batch holds between one and one register of replicas");
+    assert(spins.size() == betas.size() && "Every replica requires its initial spins");
+
+    // Resolve the periodic boundaries once, so the kernels never have to wrap around with a modulo
+    for (std::size_t i = 0; i < num_sites(); ++i) {
+        const auto row = i / length, col = i % length;
+        neighbour_table[4 * i + RIGHT] = static_cast<int32_t>(row * length + (col + 1) % length);
+        neighbour_table[4 * i + LEFT] = static_cast<int32_t>(row * length + (col + length - 1) % length);
+        neighbour_table[4 * i + DOWN] = static_cast<int32_t>((row + 1) % length * length + col);
+        neighbour_table[4 * i + UP] = static_cast<int32_t>((row + length - 1) % length * length + col);
+    }
+
+    // Unused lanes replicate the last replica, so they simulate something sensible without ever being reported
+    for (std::size_t r = 0; r < replicas; ++r) {
+        const auto source = std::min(r, betas.size() - 1);
+        set_beta(r, betas[source]);
+
+        if (!spins[source].has_value()) continue;
+        assert(spins[source]->size() == num_sites() && "Number of spins must be L^2");
+        for (std::size_t i = 0; i < num_sites(); ++i) {
+            this->spins[replicas * i + r] = (*spins[source])[i];
+        }
+    }
+
+    // Evaluate the unit vectors of the initial spins once
+    for (std::size_t i = 0; i < num_sites(); ++i) {
+        const auto proposals = propose(load(this->spins, i));
+        simd::store(cosines.data() + replicas * i, proposals.cos);
+        simd::store(sines.data() + replicas * i, proposals.sin);
+    }
+}
+
+void BatchLattice::set_beta(const std::size_t replica, const double_t beta) noexcept {
+    assert(beta > 0.0 && "Beta must be greater than zero");
+    negative_betas[replica] = -beta;
+}
+
+Proposal<BatchLattice::vector> BatchLattice::propose(const vector angles) const noexcept {
+    vector cos = simd::zero();
+    const vector sin = simd::sincos(&cos, angles);
+    return { angles, cos, sin };
+}
+
+std::tuple<BatchLattice::vector, BatchLattice::vector> BatchLattice::local_field(const std::size_t i) const noexcept {
+    const auto right = neighbour(i, RIGHT), left = neighbour(i, LEFT), down = neighbour(i, DOWN), up = neighbour(i, UP);
+    return {
+        simd::add(simd::add(load(cosines, right), load(cosines, left)), simd::add(load(cosines, down), load(cosines, up))),
+        simd::add(simd::add(load(sines, right), load(sines, left)), simd::add(load(sines, down), load(sines, up)))
+    };
+}
+
+void BatchLattice::set(const std::size_t i, const Proposal<vector> & proposals, const simd::mask mask) noexcept {
+    const auto offset = replicas * i;
+    simd::store(spins.data() + offset, simd::blend(mask, load(spins, i), proposals.angle));
+    simd::store(cosines.data() + offset, simd::blend(mask, load(cosines, i), proposals.cos));
+    simd::store(sines.data() + offset, simd::blend(mask, load(sines, i), proposals.sin));
+}
+
+BatchLattice::vector BatchLattice::energy_diff(const std::size_t i, const Proposal<vector> & proposals) const noexcept {
+    // The bond energies are dot products with the local field: (old - new) . field
+    const auto [field_cos, field_sin] = local_field(i);
+    return simd::fmadd(simd::sub(load(cosines, i), proposals.cos), field_cos, simd::mul(simd::sub(load(sines, i), proposals.sin), field_sin));
+}
+
+BatchLattice::vector BatchLattice::helicity_modulus_diff(const std::size_t i, const Proposal<vector> & proposals) const noexcept {
+    const auto left = neighbour(i, LEFT), right = neighbour(i, RIGHT);
+
+    // Expanding sin(l - a) + sin(a - r) leaves two dot products with the change of the spin
+    const vector chg_cos = simd::sub(proposals.cos, load(cosines, i)), chg_sin = simd::sub(proposals.sin, load(sines, i));
+    return simd::fmadd(chg_cos, simd::sub(load(sines, left), load(sines, right)), simd::mul(chg_sin, simd::sub(load(cosines, right), load(cosines, left))));
+}
+
+std::tuple<BatchLattice::vector, BatchLattice::vector> BatchLattice::magnetization_diff(const std::size_t i, const Proposal<vector> & proposals) const noexcept {
+    return { simd::sub(proposals.cos, load(cosines, i)), simd::sub(proposals.sin, load(sines, i)) };
+}
+
+BatchLattice::vector BatchLattice::acceptance(const vector energy_diff) const noexcept {
+    const vector exponent = simd::mul(simd::load(negative_betas.data()), energy_diff);
+    return simd::min(simd::set1(1.0), simd::exp(exponent));
+}
+
+std::tuple<BatchLattice::vector, BatchLattice::vector, std::tuple<BatchLattice::vector, BatchLattice::vector>> BatchLattice::observables() const noexcept {
+    vector energy = simd::zero(), helicity_modulus = simd::zero(), magnet_cos = simd::zero(), magnet_sin = simd::zero();
+
+    // Every bond is counted once through the right and the lower neighbour of each site
+    for (std::size_t i = 0; i < num_sites(); ++i) {
+        const auto right = neighbour(i, RIGHT), down = neighbour(i, DOWN);
+        const vector cos = load(cosines, i), sin = load(sines, i);
+        const vector right_cos = load(cosines, right), right_sin = load(sines, right);
+
+        energy = simd::fmadd(cos, simd::add(right_cos, load(cosines, down)), energy);
+        energy = simd::fmadd(sin, simd::add(right_sin, load(sines, down)), energy);
+
+        // sin(a - b) = sin(a) * cos(b) - cos(a) * sin(b)
+        helicity_modulus = simd::add(helicity_modulus, simd::sub(simd::mul(sin, right_cos), simd::mul(cos, right_sin)));
+
+        magnet_cos = simd::add(magnet_cos, cos);
+        magnet_sin = simd::add(magnet_sin, sin);
+    }
+    return { simd::sub(simd::zero(), energy), helicity_modulus, { magnet_cos, magnet_sin } };
+}
+
+std::vector<double_t> BatchLattice::get_spins(const std::size_t replica) const noexcept {
+    std::vector<double_t> result (num_sites());
+    for (std::size_t i = 0; i < num_sites(); ++i) {
+        result[i] = spins[replicas * i + replica];
+    }
+    return result;
+}
+
+BatchLattice::values BatchLattice::split(const vector v) noexcept {
+    alignas(64) values result {};
+    simd::store(result.data(), v);
+    return result;
+}
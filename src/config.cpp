@@ -1,6 +1,7 @@
 #include "config.hpp"
 
 #include <iostream>
+#include <stdexcept>
 #include <toml++/toml.hpp>
 
 AlgorithmConfig parse_algorithm_config(const toml::node_view<const toml::node> node) noexcept {
@@ -14,7 +15,39 @@ AlgorithmConfig parse_algorithm_config(const toml::node_view<const toml::node> n
 	const auto num_chunks = node["num_chunks"].value_or<std::size_t>(1);
 	const auto sweeps_per_chunk = node["sweeps_per_chunk"].value_or<std::size_t>(100000);
 
-	return AlgorithmConfig { num_chunks, sweeps_per_chunk, sizes };
+	algorithms::Options options {};
+	if (node["sweep"].value_or<std::string>("sequential") == "checkerboard") options.sweep = algorithms::CHECKERBOARD;
+	if (node["representation"].value_or<std::string>("angles") == "unit_vectors") options.representation = Lattice::UNIT_VECTORS;
+	if (node["precision"].value_or<std::string>("double") == "single") options.precision = algorithms::SINGLE;
+	options.over_relaxation = node["over_relaxation"].value_or<std::size_t>(0);
+	if (node["proposal"].value_or<std::string>("uniform") == "adaptive") options.proposal = algorithms::ADAPTIVE;
+	options.target_acceptance = node["target_acceptance"].value_or<double_t>(0.5);
+	options.tuning_sweeps = node["tuning_sweeps"].value_or<std::size_t>(1000);
+	options.recompute_interval = node["recompute_interval"].value_or<std::size_t>(0);
+	options.batch = node["batch"].value_or<bool>(false);
+
+	const auto exchange_interval = node["exchange_interval"].value_or<std::size_t>(0);
+	return AlgorithmConfig { num_chunks, sweeps_per_chunk, sizes, options, exchange_interval };
+}
+
+ValidationConfig parse_validation_config(const toml::node_view<const toml::node> node) {
+	std::unordered_set<std::size_t> sizes {};
+	node["sizes"].as_array()->for_each([&] <typename T>(T && el) {
+		if constexpr (toml::is_integer<T>) {
+			sizes.insert(el.template value_or<std::size_t>(10));
+		}
+	});
+
+	const auto temperature = node["temperature"].value_or<double_t>(0.9);
+	const auto sweeps = node["sweeps"].value_or<std::size_t>(10000);
+	const auto seed = node["seed"].value_or<std::uint64_t>(42);
+
+	// The estimates average over the second half of the sweeps, which is empty for fewer than two sweeps
+	if (sweeps < 2) {
+		throw std::invalid_argument("The validation needs at least 2 sweeps");
+	}
+
+	return ValidationConfig { sizes, temperature, sweeps, seed };
 }
 
 Config Config::from_file(const std::string_view path) {
@@ -22,6 +55,22 @@ Config Config::from_file(const std::string_view path) {
 
 	const auto simulation_id = config["simulation"]["simulation_id"].value_or<int32_t>(0);
 	const auto bootstrap_resamples = config["simulation"]["bootstrap_resamples"].value_or<std::size_t>(100000);
+	const auto bootstrap_tolerance = config["simulation"]["bootstrap_tolerance"].value_or<double_t>(0.0);
+	const auto bootstrap = config["simulation"]["bootstrap"].value_or<std::string>("independent") == "joint" ? analysis::JOINT : analysis::INDEPENDENT;
+	const auto error_estimator = config["simulation"]["error_estimator"].value_or<std::string>("bootstrap") == "jackknife" ? analysis::JACKKNIFE : analysis::BOOTSTRAP;
+	const auto autocorrelation_window = config["simulation"]["autocorrelation_window"].value_or<std::size_t>(65536);
+	const auto max_blocks = config["simulation"]["max_blocks"].value_or<std::size_t>(65536);
+	const auto autocorrelation = config["simulation"]["autocorrelation"].value_or<std::string>("fft") == "multi_tau" ? analysis::MULTI_TAU : analysis::FFT;
+	const auto wisdom_directory = config["simulation"]["wisdom_directory"].value_or<std::string>("output/wisdom");
+
+	if (autocorrelation_window == 0) {
+		throw std::invalid_argument("The autocorrelation window needs at least 1 sweep");
+	}
+
+	// The blocks are merged pairwise once all of them are filled
+	if (max_blocks < 2 || max_blocks % 2 != 0) {
+		throw std::invalid_argument("The maximum number of blocks must be even and at least 2, but got " + std::to_string(max_blocks));
+	}
 
 	const auto max_temperature = config["temperature"]["max"].value_or<int32_t>(3);
 	const auto temperature_steps = config["temperature"]["steps"].value_or<int32_t>(64);
@@ -40,6 +89,16 @@ Config Config::from_file(const std::string_view path) {
 	std::map<algorithms::Algorithm, AlgorithmConfig> algorithms;
 	if (const auto node = config["metropolis"]) algorithms.emplace(algorithms::METROPOLIS, parse_algorithm_config(node));
 	if (const auto node = config["wolff"]) algorithms.emplace(algorithms::WOLFF, parse_algorithm_config(node));
+	if (const auto node = config["heat_bath"]) algorithms.emplace(algorithms::HEAT_BATH, parse_algorithm_config(node));
+	if (const auto node = config["swendsen_wang"]) algorithms.emplace(algorithms::SWENDSEN_WANG, parse_algorithm_config(node));
+
+	std::optional<ValidationConfig> validation = std::nullopt;
+	if (const auto node = config["validation"]) validation = parse_validation_config(node);
+
+	return Config { engine, connection_string, simulation_id, bootstrap_resamples, bootstrap_tolerance, bootstrap, error_estimator, autocorrelation_window, max_blocks, autocorrelation, wisdom_directory, max_temperature, temperature_steps, max_depth, vortex_sizes, algorithms, validation };
+}
 
-	return Config { engine, connection_string, simulation_id, bootstrap_resamples, max_temperature, temperature_steps, max_depth, vortex_sizes, algorithms };
+algorithms::Options Config::options(const algorithms::Algorithm algorithm) const {
+	const auto it = algorithms.find(algorithm);
+	return it != algorithms.end() ? it->second.options : algorithms::Options {};
 }
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 
 #include <simde/x86/svml.h>
@@ -8,63 +9,256 @@
 #include "utils/utils.hpp"
 #include "algorithms/algorithms.hpp"
 
-Lattice::Lattice(const std::size_t length, const double_t beta, const std::optional<std::vector<double_t>> & spins) : beta(beta), length(length),
-        spins(spins.has_value() ? utils::aligned_vector<double_t> { spins.value().begin(), spins.value().end() } : utils::aligned_vector<double_t>(length * length)) {
+template<typename T>
+BasicLattice<T>::BasicLattice(const std::size_t length, const double_t beta, const std::optional<std::vector<double_t>> & spins, const Representation representation) : beta(beta), length(length),
+        representation(representation), spins(spins.has_value() ? utils::aligned_vector<T> { spins.value().begin(), spins.value().end() } : utils::aligned_vector<T>(length * length)),
+        neighbour_table(4 * length * length), sublattice_table(length * length) {
     assert(length * length % 4 == 0 && "Lattice size must be a multiple of 4 as the SIMD instructions won't work otherwise");
     assert(beta > 0.0 && "Beta must be greater than zero");
     assert(this->spins.size() == length * length && "Number of spins must be L^2");
+
+    // Resolve the periodic boundaries once, so the kernels never have to wrap around with a modulo
+    for (std::size_t i = 0; i < num_sites(); ++i) {
+        neighbour_table[4 * i + RIGHT] = static_cast<int32_t>(shift_col(i, 1));
+        neighbour_table[4 * i + LEFT] = static_cast<int32_t>(shift_col(i, -1));
+        neighbour_table[4 * i + DOWN] = static_cast<int32_t>(shift_row(i, 1));
+        neighbour_table[4 * i + UP] = static_cast<int32_t>(shift_row(i, -1));
+    }
+
+    const auto half = num_sites() / 2;
+    for (std::size_t color = 0; color < 2; ++color) {
+        for (std::size_t k = 0; k < half; ++k) {
+            sublattice_table[color * half + k] = static_cast<int32_t>(sublattice_site(color, k));
+        }
+    }
+
+    // Evaluate the unit vectors of the initial spins once
+    if (representation == UNIT_VECTORS) {
+        cosines.resize(num_sites());
+        sines.resize(num_sites());
+
+        for (std::size_t i = 0; i < num_sites(); ++i) {
+            const auto proposal = propose(this->spins[i]);
+            cosines[i] = static_cast<T>(proposal.cos);
+            sines[i] = static_cast<T>(proposal.sin);
+        }
+    }
 }
 
-void Lattice::set(const std::size_t i, const double_t angle) noexcept {
-    assert(angle >= 0.0 && angle < algorithms::N_PI<2> && "Angle must be on [0.0, 2PI)");
-    spins[i % num_sites()] = angle;
+template<typename T>
+typename BasicLattice<T>::index BasicLattice<T>::sublattice_sites(const std::size_t color, const std::size_t k) const noexcept {
+    assert(k % simd::lanes == 0 && "Sublattice sites are loaded in aligned groups of one register");
+    return simd::load_index(sublattice_table.data() + color * num_sites() / 2 + k);
 }
 
-double_t Lattice::energy() const noexcept {
-    simde__m256d result = simde_mm256_setzero_pd();
-    for (std::size_t i = 0; i < num_sites(); i += 2) {
-        const simde__m256d old = simde_mm256_set_pd(spins[i], spins[i], spins[i + 1], spins[i + 1]);
-        const simde__m256d neighbours = simde_mm256_set_pd(spins[shift_col(i, 1)], spins[shift_row(i, 1)],
-            spins[shift_col(i + 1, 1)], spins[shift_row(i + 1, 1)]);
+template<typename T>
+Proposal<double_t> BasicLattice<T>::propose(const double_t angle) const noexcept {
+    // Round the angle to the precision of the lattice, so the differences match the spin which is stored eventually
+    const auto value = static_cast<double_t>(static_cast<T>(angle));
+    const auto rounded = value < algorithms::N_PI<2> ? value : 0.0;
+
+    if (representation == ANGLES) {
+        return { rounded, 0.0, 0.0 };
+    }
+
+    const simde__m128d data = simde_mm_set1_pd(rounded);
+    simde__m128d cos = simde_mm_setzero_pd();
+    const simde__m128d sin = simde_mm_sincos_pd(&cos, data);
+    return { rounded, static_cast<double_t>(static_cast<T>(cos[0])), static_cast<double_t>(static_cast<T>(sin[0])) };
+}
+
+template<typename T>
+Proposal<typename BasicLattice<T>::vector> BasicLattice<T>::propose(const vector angles) const noexcept {
+    if (representation == ANGLES) {
+        return { angles, simd::zero(), simd::zero() };
+    }
+
+    vector cos = simd::zero();
+    const vector sin = simd::sincos(&cos, angles);
+    return { angles, cos, sin };
+}
+
+template<typename T>
+std::tuple<double_t, double_t> BasicLattice<T>::local_field(const std::size_t i) const noexcept {
+    if (representation == UNIT_VECTORS) {
+        return { utils::mm256_reduce_add_pd(neighbours_pd(cosines, i)), utils::mm256_reduce_add_pd(neighbours_pd(sines, i)) };
+    }
+
+    simde__m256d cos = simde_mm256_setzero_pd();
+    const simde__m256d sin = simde_mm256_sincos_pd(&cos, neighbours_pd(spins, i));
+    return { utils::mm256_reduce_add_pd(cos), utils::mm256_reduce_add_pd(sin) };
+}
+
+template<typename T>
+std::tuple<typename BasicLattice<T>::vector, typename BasicLattice<T>::vector> BasicLattice<T>::local_field(const index sites) const noexcept {
+    if (representation == UNIT_VECTORS) {
+        const auto [right_cos, left_cos, down_cos, up_cos] = neighbours(cosines, sites);
+        const auto [right_sin, left_sin, down_sin, up_sin] = neighbours(sines, sites);
+        return {
+            simd::add(simd::add(right_cos, left_cos), simd::add(down_cos, up_cos)),
+            simd::add(simd::add(right_sin, left_sin), simd::add(down_sin, up_sin))
+        };
+    }
+
+    const auto [right, left, down, up] = neighbours(spins, sites);
+    vector right_cos = simd::zero(), left_cos = simd::zero(), down_cos = simd::zero(), up_cos = simd::zero();
+    const vector right_sin = simd::sincos(&right_cos, right), left_sin = simd::sincos(&left_cos, left);
+    const vector down_sin = simd::sincos(&down_cos, down), up_sin = simd::sincos(&up_cos, up);
+    return {
+        simd::add(simd::add(right_cos, left_cos), simd::add(down_cos, up_cos)),
+        simd::add(simd::add(right_sin, left_sin), simd::add(down_sin, up_sin))
+    };
+}
+
+template<typename T>
+Proposal<double_t> BasicLattice<T>::reflect(const std::size_t i) const noexcept {
+    const auto [field_cos, field_sin] = local_field(i);
 
-        const simde__m256d diff = simde_mm256_sub_pd(old, neighbours);
-        const simde__m256d cos = simde_mm256_cos_pd(diff);
+    // A vanishing local field gives phi = 0, which is fine as the bond energies of the site are zero in any direction
+    const auto phi = std::atan2(field_sin, field_cos);
+    return propose(std::fmod(2.0 * phi - static_cast<double_t>(spins[i]) + algorithms::N_PI<4>, algorithms::N_PI<2>));
+}
+
+template<typename T>
+Proposal<typename BasicLattice<T>::vector> BasicLattice<T>::reflect(const index sites) const noexcept {
+    const auto [field_cos, field_sin] = local_field(sites);
+
+    const vector phi = simd::atan2(field_sin, field_cos);
+    return propose(wrap(simd::sub(simd::add(phi, phi), simd::gather(spins.data(), sites))));
+}
+
+template<typename T>
+Proposal<double_t> BasicLattice<T>::displace(const std::size_t i, const double_t delta) const noexcept {
+    return propose(std::fmod(static_cast<double_t>(spins[i]) + delta + algorithms::N_PI<2>, algorithms::N_PI<2>));
+}
+
+template<typename T>
+Proposal<typename BasicLattice<T>::vector> BasicLattice<T>::displace(const index sites, const vector deltas) const noexcept {
+    return propose(wrap(simd::add(simd::gather(spins.data(), sites), deltas)));
+}
+
+template<typename T>
+typename BasicLattice<T>::vector BasicLattice<T>::wrap(const vector angles) noexcept {
+    // Rounding may still land on 2PI itself, which is mapped onto 0
+    const vector two_pi = simd::set1(static_cast<T>(algorithms::N_PI<2>));
+    const vector wrapped = simd::sub(angles, simd::mul(two_pi, simd::floor(simd::mul(angles, simd::set1(static_cast<T>(1.0 / algorithms::N_PI<2>))))));
+    return simd::select(simd::greater(two_pi, wrapped), wrapped);
+}
 
-        result = simde_mm256_add_pd(result, cos);
+template<typename T>
+void BasicLattice<T>::set(const std::size_t i, const double_t angle) noexcept {
+    set(i, propose(angle));
+}
+
+template<typename T>
+void BasicLattice<T>::set(const std::size_t i, const Proposal<double_t> & proposal) noexcept {
+    assert(proposal.angle >= 0.0 && proposal.angle < algorithms::N_PI<2> && "Angle must be on [0.0, 2PI)");
+    spins[i % num_sites()] = static_cast<T>(proposal.angle);
+
+    if (representation == UNIT_VECTORS) {
+        cosines[i % num_sites()] = static_cast<T>(proposal.cos);
+        sines[i % num_sites()] = static_cast<T>(proposal.sin);
     }
-    return -utils::mm256_reduce_add_pd(result);
 }
 
-double_t Lattice::energy_diff(const std::size_t i, const double_t angle) const noexcept {
-    const simde__m256d neighbours = simde_mm256_set_pd(spins[shift_col(i, 1)], spins[shift_col(i, -1)], spins[shift_row(i, 1)], spins[shift_row(i, -1)]);
+template<typename T>
+void BasicLattice<T>::set(const index sites, const Proposal<vector> & proposals, const int32_t mask) noexcept {
+    alignas(32) int32_t indices[simd::lanes];
+    alignas(32) T angles[simd::lanes], cos[simd::lanes], sin[simd::lanes];
+    simd::store_index(indices, sites);
+    simd::store(angles, proposals.angle);
+    simd::store(cos, proposals.cos);
+    simd::store(sin, proposals.sin);
+
+    // Sites of the same sublattice are two apart, so the accepted lanes are scattered one by one
+    for (std::size_t k = 0; k < simd::lanes; ++k) {
+        if (mask & (1 << k)) {
+            spins[indices[k]] = angles[k];
+            if (representation == UNIT_VECTORS) {
+                cosines[indices[k]] = cos[k];
+                sines[indices[k]] = sin[k];
+            }
+        }
+    }
+}
+
+template<typename T>
+std::tuple<typename BasicLattice<T>::vector, typename BasicLattice<T>::vector, typename BasicLattice<T>::vector, typename BasicLattice<T>::vector>
+BasicLattice<T>::neighbours(const utils::aligned_vector<T> & values, const index sites) const noexcept {
+    const auto gather = [&] (const Direction direction) {
+        return simd::gather(values.data(), simd::gather_table(neighbour_table.data(), sites, direction));
+    };
+
+    return { gather(RIGHT), gather(LEFT), gather(DOWN), gather(UP) };
+}
+
+template<typename T>
+simde__m256d BasicLattice<T>::neighbours_pd(const utils::aligned_vector<T> & values, const std::size_t i) const noexcept {
+    const simde__m128i indices = simde_mm_load_si128(reinterpret_cast<const simde__m128i *>(neighbour_table.data() + 4 * i));
+    return simd::gather_pd(values.data(), indices);
+}
+
+template<typename T>
+double_t BasicLattice<T>::energy_diff(const std::size_t i, const Proposal<double_t> & proposal) const noexcept {
+    // Summing up the neighbouring unit vectors first leaves a single dot product with the change of the spin
+    if (representation == UNIT_VECTORS) {
+        const auto neighbours_cos = utils::mm256_reduce_add_pd(neighbours_pd(cosines, i));
+        const auto neighbours_sin = utils::mm256_reduce_add_pd(neighbours_pd(sines, i));
+        return (cosines[i] - proposal.cos) * neighbours_cos + (sines[i] - proposal.sin) * neighbours_sin;
+    }
+
+    const simde__m256d neighbours = neighbours_pd(spins, i);
 
     const simde__m256d a = simde_mm256_set1_pd(spins[i]);
     const simde__m256d before = simde_mm256_cos_pd(simde_mm256_sub_pd(a, neighbours));
 
-    const simde__m256d b = simde_mm256_set1_pd(angle);
+    const simde__m256d b = simde_mm256_set1_pd(proposal.angle);
     const simde__m256d after = simde_mm256_cos_pd(simde_mm256_sub_pd(b, neighbours));
 
     return utils::mm256_reduce_add_pd(before) - utils::mm256_reduce_add_pd(after);
 }
 
-double_t Lattice::helicity_modulus() const noexcept {
-    simde__m256d result = simde_mm256_setzero_pd();
-    for (std::size_t i = 0; i < num_sites(); i += 4) {
-        const simde__m256d data = simde_mm256_load_pd(spins.data() + i);
-        const simde__m256d neighbours = simde_mm256_set_pd(spins[shift_col(i + 3, 1)], spins[shift_col(i + 2, 1)], spins[shift_col(i + 1, 1)], spins[shift_col(i, 1)]);
+template<typename T>
+typename BasicLattice<T>::vector BasicLattice<T>::energy_diff(const index sites, const Proposal<vector> & proposals) const noexcept {
+    if (representation == UNIT_VECTORS) {
+        const auto [right_cos, left_cos, down_cos, up_cos] = neighbours(cosines, sites);
+        const auto [right_sin, left_sin, down_sin, up_sin] = neighbours(sines, sites);
 
-        const simde__m256d pi = simde_mm256_set1_pd(algorithms::N_PI<2>);
-        const simde__m256d diff = simde_mm256_sub_pd(simde_mm256_add_pd(data, pi), neighbours);
+        const vector neighbours_cos = simd::add(simd::add(right_cos, left_cos), simd::add(down_cos, up_cos));
+        const vector neighbours_sin = simd::add(simd::add(right_sin, left_sin), simd::add(down_sin, up_sin));
 
-        const simde__m256d sin = simde_mm256_sin_pd(diff);
-        result = simde_mm256_add_pd(result, sin);
+        const vector chg_cos = simd::sub(simd::gather(cosines.data(), sites), proposals.cos);
+        const vector chg_sin = simd::sub(simd::gather(sines.data(), sites), proposals.sin);
+        return simd::fmadd(chg_cos, neighbours_cos, simd::mul(chg_sin, neighbours_sin));
     }
-    return utils::mm256_reduce_add_pd(result);
+
+    const auto [right, left, down, up] = neighbours(spins, sites);
+    const vector old = simd::gather(spins.data(), sites);
+    const vector angles = proposals.angle;
+
+    vector before = simd::add(simd::cos(simd::sub(old, right)), simd::cos(simd::sub(old, left)));
+    before = simd::add(before, simd::cos(simd::sub(old, down)));
+    before = simd::add(before, simd::cos(simd::sub(old, up)));
+
+    vector after = simd::add(simd::cos(simd::sub(angles, right)), simd::cos(simd::sub(angles, left)));
+    after = simd::add(after, simd::cos(simd::sub(angles, down)));
+    after = simd::add(after, simd::cos(simd::sub(angles, up)));
+
+    return simd::sub(before, after);
 }
 
-double_t Lattice::helicity_modulus_diff(const std::size_t i, const double_t angle) const noexcept {
-    const simde__m256d data = simde_mm256_set_pd(spins[i], angle, spins[shift_col(i, -1)], spins[shift_col(i, -1)]);
-    const simde__m256d neighbours = simde_mm256_set_pd(spins[shift_col(i, 1)], spins[shift_col(i, 1)], spins[i], angle);
+template<typename T>
+double_t BasicLattice<T>::helicity_modulus_diff(const std::size_t i, const Proposal<double_t> & proposal) const noexcept {
+    const auto left = neighbour(i, LEFT), right = neighbour(i, RIGHT);
+
+    // Expanding sin(l - a) + sin(a - r) leaves two dot products with the change of the spin
+    if (representation == UNIT_VECTORS) {
+        const auto chg_cos = proposal.cos - cosines[i], chg_sin = proposal.sin - sines[i];
+        return chg_cos * (sines[left] - sines[right]) + chg_sin * (cosines[right] - cosines[left]);
+    }
+
+    const simde__m256d data = simde_mm256_set_pd(spins[i], proposal.angle, spins[left], spins[left]);
+    const simde__m256d neighbours = simde_mm256_set_pd(spins[right], spins[right], spins[i], proposal.angle);
 
     const simde__m256d pi = simde_mm256_set1_pd(algorithms::N_PI<2>);
     const simde__m256d diff = simde_mm256_sub_pd(simde_mm256_add_pd(data, pi), neighbours);
@@ -73,10 +267,41 @@ double_t Lattice::helicity_modulus_diff(const std::size_t i, const double_t angl
     return sin[0] + sin[2] - (sin[1] + sin[3]);
 }
 
-std::tuple<double_t, double_t> Lattice::magnetization() const noexcept {
+template<typename T>
+typename BasicLattice<T>::vector BasicLattice<T>::helicity_modulus_diff(const index sites, const Proposal<vector> & proposals) const noexcept {
+    if (representation == UNIT_VECTORS) {
+        const auto [right_cos, left_cos, _1, _2] = neighbours(cosines, sites);
+        const auto [right_sin, left_sin, _3, _4] = neighbours(sines, sites);
+
+        const vector chg_cos = simd::sub(proposals.cos, simd::gather(cosines.data(), sites));
+        const vector chg_sin = simd::sub(proposals.sin, simd::gather(sines.data(), sites));
+        return simd::fmadd(chg_cos, simd::sub(left_sin, right_sin), simd::mul(chg_sin, simd::sub(right_cos, left_cos)));
+    }
+
+    const auto [right, left, _1, _2] = neighbours(spins, sites);
+    const vector old = simd::gather(spins.data(), sites);
+    const vector angles = proposals.angle;
+
+    const vector after = simd::add(simd::sin(simd::sub(left, angles)), simd::sin(simd::sub(angles, right)));
+    const vector before = simd::add(simd::sin(simd::sub(left, old)), simd::sin(simd::sub(old, right)));
+
+    return simd::sub(after, before);
+}
+
+template<typename T>
+std::tuple<double_t, double_t> BasicLattice<T>::magnetization() const noexcept {
     simde__m256d result = simde_mm256_setzero_pd();
+
+    if (representation == UNIT_VECTORS) {
+        for (std::size_t i = 0; i < num_sites(); i += 4) {
+            const simde__m256d add = simde_mm256_hadd_pd(simd::load_pd(cosines.data() + i), simd::load_pd(sines.data() + i));
+            result = simde_mm256_add_pd(result, add);
+        }
+        return {result[0] + result[2], result[1] + result[3]};
+    }
+
     for (std::size_t i = 0; i < num_sites(); i += 4) {
-        const simde__m256d data = simde_mm256_load_pd(spins.data() + i);
+        const simde__m256d data = simd::load_pd(spins.data() + i);
 
         simde__m256d cos = simde_mm256_setzero_pd();
         const simde__m256d sin = simde_mm256_sincos_pd(&cos, data);
@@ -87,8 +312,13 @@ std::tuple<double_t, double_t> Lattice::magnetization() const noexcept {
     return {result[0] + result[2], result[1] + result[3]};
 }
 
-std::tuple<double_t, double_t> Lattice::magnetization_diff(const std::size_t i, const double_t angle) const noexcept {
-    const simde__m128d data = simde_mm_set_pd(angle, algorithms::N_PI<1> + spins[i]);
+template<typename T>
+std::tuple<double_t, double_t> BasicLattice<T>::magnetization_diff(const std::size_t i, const Proposal<double_t> & proposal) const noexcept {
+    if (representation == UNIT_VECTORS) {
+        return {proposal.cos - cosines[i], proposal.sin - sines[i]};
+    }
+
+    const simde__m128d data = simde_mm_set_pd(proposal.angle, algorithms::N_PI<1> + spins[i]);
 
     simde__m128d cos = simde_mm_setzero_pd();
     const simde__m128d sin = simde_mm_sincos_pd(&cos, data);
@@ -96,10 +326,173 @@ std::tuple<double_t, double_t> Lattice::magnetization_diff(const std::size_t i,
     return {cos[0] + cos[1], sin[0] + sin[1]};
 }
 
-double_t Lattice::acceptance(const double_t energy_diff) const noexcept {
+template<typename T>
+std::tuple<typename BasicLattice<T>::vector, typename BasicLattice<T>::vector> BasicLattice<T>::magnetization_diff(const index sites, const Proposal<vector> & proposals) const noexcept {
+    if (representation == UNIT_VECTORS) {
+        return {
+            simd::sub(proposals.cos, simd::gather(cosines.data(), sites)),
+            simd::sub(proposals.sin, simd::gather(sines.data(), sites))
+        };
+    }
+
+    const vector old = simd::gather(spins.data(), sites);
+
+    vector cos_before = simd::zero(), cos_after = simd::zero();
+    const vector sin_before = simd::sincos(&cos_before, old);
+    const vector sin_after = simd::sincos(&cos_after, proposals.angle);
+
+    return {simd::sub(cos_after, cos_before), simd::sub(sin_after, sin_before)};
+}
+
+template<typename T>
+Changes<double_t> BasicLattice<T>::changes(const std::size_t i, const Proposal<double_t> & proposal) const noexcept {
+    simde__m256d neighbours_cos, neighbours_sin;
+    double_t old_cos, old_sin, new_cos, new_sin;
+
+    if (representation == UNIT_VECTORS) {
+        neighbours_cos = neighbours_pd(cosines, i);
+        neighbours_sin = neighbours_pd(sines, i);
+        old_cos = cosines[i], old_sin = sines[i], new_cos = proposal.cos, new_sin = proposal.sin;
+    } else {
+        // One sincos of the four neighbours and one of the old and the proposed angle cover all observables
+        neighbours_cos = simde_mm256_setzero_pd();
+        neighbours_sin = simde_mm256_sincos_pd(&neighbours_cos, neighbours_pd(spins, i));
+
+        simde__m128d cos = simde_mm_setzero_pd();
+        const simde__m128d sin = simde_mm_sincos_pd(&cos, simde_mm_set_pd(proposal.angle, spins[i]));
+        old_cos = cos[0], old_sin = sin[0], new_cos = cos[1], new_sin = sin[1];
+    }
+
+    // The lanes hold the neighbours in the order of Direction
+    alignas(32) double_t cos[4], sin[4];
+    simde_mm256_store_pd(cos, neighbours_cos);
+    simde_mm256_store_pd(sin, neighbours_sin);
+
+    const auto field_cos = (cos[RIGHT] + cos[LEFT]) + (cos[DOWN] + cos[UP]), field_sin = (sin[RIGHT] + sin[LEFT]) + (sin[DOWN] + sin[UP]);
+    const auto chg_cos = new_cos - old_cos, chg_sin = new_sin - old_sin;
+    return {
+        -(chg_cos * field_cos + chg_sin * field_sin),
+        chg_cos * (sin[LEFT] - sin[RIGHT]) + chg_sin * (cos[RIGHT] - cos[LEFT]),
+        chg_cos, chg_sin
+    };
+}
+
+template<typename T>
+Changes<typename BasicLattice<T>::vector> BasicLattice<T>::changes(const index sites, const Proposal<vector> & proposals) const noexcept {
+    vector right_cos, left_cos, down_cos, up_cos, right_sin, left_sin, down_sin, up_sin, old_cos, old_sin, new_cos, new_sin;
+
+    if (representation == UNIT_VECTORS) {
+        std::tie(right_cos, left_cos, down_cos, up_cos) = neighbours(cosines, sites);
+        std::tie(right_sin, left_sin, down_sin, up_sin) = neighbours(sines, sites);
+        old_cos = simd::gather(cosines.data(), sites), old_sin = simd::gather(sines.data(), sites);
+        new_cos = proposals.cos, new_sin = proposals.sin;
+    } else {
+        const auto [right, left, down, up] = neighbours(spins, sites);
+        right_sin = simd::sincos(&right_cos, right), left_sin = simd::sincos(&left_cos, left);
+        down_sin = simd::sincos(&down_cos, down), up_sin = simd::sincos(&up_cos, up);
+        old_sin = simd::sincos(&old_cos, simd::gather(spins.data(), sites));
+        new_sin = simd::sincos(&new_cos, proposals.angle);
+    }
+
+    const vector field_cos = simd::add(simd::add(right_cos, left_cos), simd::add(down_cos, up_cos));
+    const vector field_sin = simd::add(simd::add(right_sin, left_sin), simd::add(down_sin, up_sin));
+    const vector chg_cos = simd::sub(new_cos, old_cos), chg_sin = simd::sub(new_sin, old_sin);
+    return {
+        simd::sub(simd::zero(), simd::fmadd(chg_cos, field_cos, simd::mul(chg_sin, field_sin))),
+        simd::fmadd(chg_cos, simd::sub(left_sin, right_sin), simd::mul(chg_sin, simd::sub(right_cos, left_cos))),
+        chg_cos, chg_sin
+    };
+}
+
+template<typename T>
+std::tuple<double_t, double_t, std::tuple<double_t, double_t>> BasicLattice<T>::observables() const noexcept {
+    const T * cos = cosines.data(), * sin = sines.data();
+
+    // Evaluate the unit vector of every site once, so each bond below is a product of two of them
+    utils::aligned_vector<T> buffer_cos, buffer_sin;
+    if (representation == ANGLES) {
+        buffer_cos.resize(num_sites());
+        buffer_sin.resize(num_sites());
+        const auto registers = num_sites() - num_sites() % simd::lanes;
+        for (std::size_t i = 0; i < registers; i += simd::lanes) {
+            vector site_cos = simd::zero();
+            simd::store(buffer_sin.data() + i, simd::sincos(&site_cos, simd::load(spins.data() + i)));
+            simd::store(buffer_cos.data() + i, site_cos);
+        }
+        for (std::size_t i = registers; i < num_sites(); ++i) {
+            buffer_cos[i] = static_cast<T>(std::cos(spins[i]));
+            buffer_sin[i] = static_cast<T>(std::sin(spins[i]));
+        }
+        cos = buffer_cos.data(), sin = buffer_sin.data();
+    }
+
+    // Every bond is counted once through the right and the lower neighbour of each site
+    if (length % simd::lanes != 0) {
+        double_t energy = 0.0, helicity_modulus = 0.0, magnet_cos = 0.0, magnet_sin = 0.0;
+        for (std::size_t i = 0; i < num_sites(); ++i) {
+            const auto right = neighbour(i, RIGHT), down = neighbour(i, DOWN);
+            const double_t site_cos = cos[i], site_sin = sin[i], right_cos = cos[right], right_sin = sin[right];
+
+            energy -= site_cos * (right_cos + static_cast<double_t>(cos[down])) + site_sin * (right_sin + static_cast<double_t>(sin[down]));
+            helicity_modulus += site_sin * right_cos - site_cos * right_sin;
+            magnet_cos += site_cos;
+            magnet_sin += site_sin;
+        }
+        return { energy, helicity_modulus, { magnet_cos, magnet_sin } };
+    }
+
+    // Rows which fill whole registers are streamed instead. The row below is an aligned load and the right neighbours are
+    // an unaligned load one site further, except for the last register of a row where the first site wraps around.
+    simde__m256d energy = simde_mm256_setzero_pd(), helicity_modulus = simde_mm256_setzero_pd();
+    simde__m256d magnet_cos = simde_mm256_setzero_pd(), magnet_sin = simde_mm256_setzero_pd();
+    alignas(64) T wrapped_cos[simd::lanes], wrapped_sin[simd::lanes];
+
+    for (std::size_t row = 0; row < length; ++row) {
+        const auto begin = row * length, below = (row + 1) % length * length;
+        for (std::size_t col = 0; col < length; col += simd::lanes) {
+            const auto i = begin + col;
+            const vector site_cos = simd::load(cos + i), site_sin = simd::load(sin + i);
+            const vector down_cos = simd::load(cos + below + col), down_sin = simd::load(sin + below + col);
+
+            vector right_cos, right_sin;
+            if (col + simd::lanes < length) {
+                right_cos = simd::loadu(cos + i + 1), right_sin = simd::loadu(sin + i + 1);
+            } else {
+                std::copy_n(cos + i + 1, simd::lanes - 1, wrapped_cos);
+                std::copy_n(sin + i + 1, simd::lanes - 1, wrapped_sin);
+                wrapped_cos[simd::lanes - 1] = cos[begin], wrapped_sin[simd::lanes - 1] = sin[begin];
+                right_cos = simd::load(wrapped_cos), right_sin = simd::load(wrapped_sin);
+            }
+
+            const vector bonds = simd::fmadd(site_cos, simd::add(right_cos, down_cos), simd::mul(site_sin, simd::add(right_sin, down_sin)));
+            energy = simd::accumulate(energy, bonds);
+            helicity_modulus = simd::accumulate(helicity_modulus, simd::sub(simd::mul(site_sin, right_cos), simd::mul(site_cos, right_sin)));
+            magnet_cos = simd::accumulate(magnet_cos, site_cos);
+            magnet_sin = simd::accumulate(magnet_sin, site_sin);
+        }
+    }
+
+    return {
+        -utils::mm256_reduce_add_pd(energy), utils::mm256_reduce_add_pd(helicity_modulus),
+        { utils::mm256_reduce_add_pd(magnet_cos), utils::mm256_reduce_add_pd(magnet_sin) }
+    };
+}
+
+template<typename T>
+double_t BasicLattice<T>::acceptance(const double_t energy_diff) const noexcept {
     return std::min(1.0, std::exp(-beta * energy_diff));
 }
 
-std::vector<double_t> Lattice::get_spins() const noexcept {
+template<typename T>
+typename BasicLattice<T>::vector BasicLattice<T>::acceptance(const vector energy_diff) const noexcept {
+    const vector exponent = simd::mul(simd::set1(static_cast<T>(-beta)), energy_diff);
+    return simd::min(simd::set1(1.0), simd::exp(exponent));
+}
+
+template<typename T>
+std::vector<double_t> BasicLattice<T>::get_spins() const noexcept {
     return { this->spins.begin(), this->spins.end() };
-}
\ No newline at end of file
+}
+
+template class BasicLattice<float>;
+template class BasicLattice<double>;
@@ -1,11 +1,15 @@
+#include <cmath>
 #include <iostream>
 
 #include "config.hpp"
 #include "storage/postgres_storage.hpp"
 #include "storage/sqlite_storage.hpp"
+#include "algorithms/simulator.hpp"
 
 #include "tasks/simulation.hpp"
+#include "tasks/tempering.hpp"
 #include "tasks/bootstrap.hpp"
+#include "tasks/joint_bootstrap.hpp"
 #include "tasks/derivatives.hpp"
 #include "tasks/vortices.hpp"
 
@@ -14,11 +18,23 @@ int run(const Config & config, std::string_view connection_string) {
     // Read configuration from TOML
     auto storage = std::make_shared<TStorage>(connection_string);
 
+    // FFT plans are measured once per host and reused by all later runs
+    const auto wisdom = std::filesystem::path { config.wisdom_directory } / (utils::hostname() + ".wisdom");
+    analysis::load_wisdom(wisdom);
+
     // Prepare the database for simulation
     while (storage->prepare_simulation(config)) {
         tasks::Simulation<TStorage> { config, storage }.execute();
-        tasks::Bootstrap<TStorage> { config, storage }.execute();
-        tasks::Derivatives<TStorage> { config, storage }.execute();
+        tasks::Tempering<TStorage> { config, storage }.execute();
+        analysis::save_wisdom(wisdom);
+
+        // The joint bootstrap derives the specific heat, susceptibility and helicity modulus itself
+        if (config.bootstrap == analysis::JOINT) {
+            tasks::JointBootstrap<TStorage> { config, storage }.execute();
+        } else {
+            tasks::Bootstrap<TStorage> { config, storage }.execute();
+            tasks::Derivatives<TStorage> { config, storage }.execute();
+        }
 
         std::cout << "Synchronizing workers..." << std::endl;
         storage->synchronize_workers();
@@ -31,9 +47,33 @@ int run(const Config & config, std::string_view connection_string) {
     return 0;
 }
 
+/**
+ * Simulates every configured algorithm and lattice size once in double and once in single precision on the same seed
+ * and prints the estimates of both runs next to each other.
+ */
+int validate(const Config & config, const ValidationConfig & validation) {
+    for (const auto & [algorithm, algorithm_config] : config.algorithms) {
+        for (const auto size : validation.sizes) {
+            std::cout << "[Validation] " << algorithm << " | Size: " << size << " | Temperature: " << validation.temperature << std::endl;
+            for (const auto & [type, estimates] : algorithms::validate_precision(size, validation.temperature, validation.sweeps, validation.seed, algorithm, algorithm_config.options)) {
+                const auto [double_precision, single_precision] = estimates;
+                std::cout << "[Validation] " << type << " | Double: " << double_precision << " | Single: " << single_precision
+                    << " | Deviation: " << std::abs(single_precision - double_precision) / std::abs(double_precision) << std::endl;
+            }
+        }
+    }
+    return 0;
+}
+
 int main() {
     try {
         const auto config = Config::from_file("config.toml");
+        std::cout << "[Dispatch] Using the " << algorithms::detect_isa() << " kernels" << std::endl;
+
+        if (config.validation.has_value()) {
+            return validate(config, config.validation.value());
+        }
+
         if (config.engine == PostgreSQLEngine) {
             return run<PostgresStorage>(config, config.connection_string);
         }
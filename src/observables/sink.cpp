@@ -0,0 +1,186 @@
+#include "observables/sink.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <ranges>
+
+observables::Series::Series(const std::size_t sweeps) : sweeps(sweeps) {
+
+}
+
+void observables::Series::push(const Type type, const double_t value) {
+	auto & values = series[type];
+	if (values.empty()) values.reserve(sweeps);
+	values.push_back(value);
+}
+
+const std::unordered_map<observables::Type, std::vector<double_t>> & observables::Series::values() const noexcept {
+	return series;
+}
+
+std::unordered_map<observables::Type, std::vector<double_t>> observables::Series::release() noexcept {
+	return std::move(series);
+}
+
+void observables::Moments::push(const Type type, const double_t value) {
+	auto & moment = moments[type];
+	const auto delta = value - moment.mean;
+	moment.mean += delta / static_cast<double_t>(++moment.count);
+	moment.m2 += delta * (value - moment.mean);
+}
+
+std::vector<observables::Type> observables::Moments::types() const {
+	std::vector<Type> result;
+	for (const auto & type : moments | std::views::keys) result.push_back(type);
+	return result;
+}
+
+std::size_t observables::Moments::count(const Type type) const {
+	return moments.at(type).count;
+}
+
+double_t observables::Moments::mean(const Type type) const {
+	return moments.at(type).mean;
+}
+
+double_t observables::Moments::variance(const Type type) const {
+	const auto & moment = moments.at(type);
+	return moment.count > 1 ? moment.m2 / static_cast<double_t>(moment.count - 1) : 0.0;
+}
+
+observables::Blocking::Blocking(const std::size_t capacity) : capacity(capacity) {
+	assert(capacity >= 2 && capacity % 2 == 0 && "Blocks are merged pairwise, so their number must be even");
+}
+
+void observables::Blocking::push(const Type type, const double_t value) {
+	auto & block = blocks[type];
+	block.pending += value;
+	if (++block.pending_count < block.size) return;
+
+	if (block.sums.empty()) block.sums.reserve(capacity);
+	block.sums.push_back(block.pending);
+	block.pending = 0.0;
+	block.pending_count = 0;
+	if (block.sums.size() < capacity) return;
+
+	// Merge neighbouring blocks, which frees half of the blocks for twice as many sweeps each
+	for (std::size_t i = 0; i < capacity / 2; ++i) {
+		block.sums[i] = block.sums[2 * i] + block.sums[2 * i + 1];
+	}
+	block.sums.resize(capacity / 2);
+	block.size *= 2;
+}
+
+std::vector<double_t> observables::Blocking::reblock(const Type type, const std::size_t stride) const {
+	const auto & block = blocks.at(type);
+	const auto group = std::max<std::size_t>((stride + block.size - 1) / block.size, 1);
+
+	std::vector<double_t> result;
+	result.reserve(block.sums.size() / group + 1);
+
+	double_t sum = 0.0;
+	std::size_t count = 0;
+	for (const auto value : block.sums) {
+		sum += value;
+		count += block.size;
+		if (count < group * block.size) continue;
+
+		result.push_back(sum / static_cast<double_t>(count));
+		sum = 0.0;
+		count = 0;
+	}
+
+	// The values left over form a shorter last block
+	sum += block.pending;
+	count += block.pending_count;
+	if (count > 0) result.push_back(sum / static_cast<double_t>(count));
+	return result;
+}
+
+std::vector<observables::Type> observables::Blocking::types() const {
+	std::vector<Type> result;
+	for (const auto & type : blocks | std::views::keys) result.push_back(type);
+	return result;
+}
+
+observables::RingBuffer::RingBuffer(const std::size_t capacity) : capacity(capacity) {
+	assert(capacity > 0 && "The ring buffer must hold at least one value");
+}
+
+void observables::RingBuffer::push(const Type type, const double_t value) {
+	auto & buffer = buffers[type];
+	if (buffer.values.size() < capacity) {
+		if (buffer.values.empty()) buffer.values.reserve(capacity);
+		buffer.values.push_back(value);
+		return;
+	}
+
+	buffer.values[buffer.next] = value;
+	buffer.next = (buffer.next + 1) % capacity;
+}
+
+std::vector<double_t> observables::RingBuffer::values(const Type type) const {
+	const auto & buffer = buffers.at(type);
+	std::vector<double_t> result;
+	result.reserve(buffer.values.size());
+	result.insert(result.end(), buffer.values.begin() + static_cast<std::ptrdiff_t>(buffer.next), buffer.values.end());
+	result.insert(result.end(), buffer.values.begin(), buffer.values.begin() + static_cast<std::ptrdiff_t>(buffer.next));
+	return result;
+}
+
+observables::Correlator::Correlator(const std::size_t channels) : channels(channels) {
+	assert(channels >= 2 && channels % 2 == 0 && "Every level covers the upper half of its channels");
+}
+
+void observables::Correlator::push(const Type type, const double_t value) {
+	auto & correlation = correlations[type];
+	if (correlation.count == 0) correlation.shift = value;
+
+	const auto shifted = value - correlation.shift;
+	correlation.sum += shifted;
+	correlation.count++;
+	insert(correlation, 0, shifted);
+}
+
+void observables::Correlator::insert(Correlation & correlation, const std::size_t level, const double_t value) const {
+	if (level == correlation.levels.size()) {
+		correlation.levels.push_back({ std::vector<double_t>(channels), 0, 0, std::vector<double_t>(channels), std::vector<std::size_t>(channels) });
+	}
+
+	auto & current = correlation.levels[level];
+	current.head = (current.head + channels - 1) % channels;
+	current.values[current.head] = value;
+	current.inserted++;
+
+	// The lower half of the lags of all but the first level is already covered by the level below
+	const auto available = std::min(current.inserted, channels);
+	for (auto lag = level == 0 ? 0 : channels / 2; lag < available; ++lag) {
+		current.products[lag] += value * current.values[(current.head + lag) % channels];
+		current.counts[lag]++;
+	}
+
+	current.pending += value;
+	if (++current.pending_count < 2) return;
+
+	const auto average = current.pending / 2.0;
+	current.pending = 0.0;
+	current.pending_count = 0;
+	insert(correlation, level + 1, average);
+}
+
+std::vector<std::tuple<std::size_t, double_t>> observables::Correlator::autocorrelation(const Type type) const {
+	const auto & correlation = correlations.at(type);
+	const auto mean = correlation.sum / static_cast<double_t>(correlation.count);
+	const auto & first = correlation.levels.front();
+	const auto variance = first.products[0] / static_cast<double_t>(first.counts[0]) - mean * mean;
+
+	std::vector<std::tuple<std::size_t, double_t>> result;
+	for (std::size_t level = 0; level < correlation.levels.size(); ++level) {
+		const auto & current = correlation.levels[level];
+		for (auto lag = level == 0 ? 0 : channels / 2; lag < channels && current.counts[lag] > 0; ++lag) {
+			const auto covariance = current.products[lag] / static_cast<double_t>(current.counts[lag]) - mean * mean;
+			result.emplace_back(lag << level, covariance / variance);
+		}
+	}
+	return result;
+}
@@ -12,26 +12,46 @@ CREATE TABLE IF NOT EXISTS "simulations" (
 	simulation_id			INTEGER				NOT NULL,
 
 	bootstrap_resamples		INTEGER				NOT NULL DEFAULT (100000) CHECK (bootstrap_resamples > 0),
+	bootstrap_tolerance		REAL				NOT NULL DEFAULT (0.0) CHECK (bootstrap_tolerance >= 0.0),
+	error_estimator			INTEGER				NOT NULL DEFAULT (0) CHECK (error_estimator = 0 OR error_estimator = 1),
 	created_at				BIGINT				NOT NULL,
 
 	CONSTRAINT "PK.Simulations_SimulationId" PRIMARY KEY (simulation_id)
 );
 
+ALTER TABLE "simulations" ADD COLUMN IF NOT EXISTS bootstrap_tolerance REAL NOT NULL DEFAULT (0.0) CHECK (bootstrap_tolerance >= 0.0);
+ALTER TABLE "simulations" ADD COLUMN IF NOT EXISTS error_estimator INTEGER NOT NULL DEFAULT (0) CHECK (error_estimator = 0 OR error_estimator = 1);
+
 
 CREATE TABLE IF NOT EXISTS "metadata" (
 	metadata_id				INTEGER				NOT NULL GENERATED ALWAYS AS IDENTITY,
 
 	simulation_id			INTEGER				NOT NULL,
-	algorithm				INTEGER				NOT NULL CHECK (algorithm = 0 OR algorithm = 1),
+	algorithm				INTEGER				NOT NULL CHECK (algorithm = 0 OR algorithm = 1 OR algorithm = 2 OR algorithm = 3),
 	num_chunks				INTEGER				NOT NULL DEFAULT (10) CHECK (num_chunks > 0),
 	sweeps_per_chunk		INTEGER				NOT NULL DEFAULT (100000) CHECK (sweeps_per_chunk > 0),
+	exchange_interval		INTEGER				NOT NULL DEFAULT (0) CHECK (exchange_interval >= 0),
 
 	CONSTRAINT "PK.Metadata_SimulationId" PRIMARY KEY (metadata_id),
 	CONSTRAINT "FK.Metadata_SimulationId" FOREIGN KEY (simulation_id) REFERENCES "simulations" (simulation_id)
 );
 
+ALTER TABLE "metadata" ADD COLUMN IF NOT EXISTS exchange_interval INTEGER NOT NULL DEFAULT (0) CHECK (exchange_interval >= 0);
+
 CREATE UNIQUE INDEX IF NOT EXISTS "IX.Metadata_SimulationId_Algorithm" ON "metadata" (simulation_id, algorithm);
 
+-- Tables created before heat bath and Swendsen-Wang were added only admit Metropolis and Wolff
+DO $BODY$
+BEGIN
+	IF EXISTS (
+		SELECT 1 FROM pg_constraint WHERE conrelid = '"metadata"'::regclass AND conname = 'metadata_algorithm_check' AND pg_get_constraintdef(oid) NOT LIKE '%algorithm = 3%'
+	) THEN
+		ALTER TABLE "metadata" DROP CONSTRAINT "metadata_algorithm_check";
+		ALTER TABLE "metadata" ADD CONSTRAINT "metadata_algorithm_check" CHECK (algorithm = 0 OR algorithm = 1 OR algorithm = 2 OR algorithm = 3);
+	END IF;
+END;
+$BODY$;
+
 
 CREATE TABLE IF NOT EXISTS "workers" (
 	worker_id				INTEGER				NOT NULL GENERATED ALWAYS AS IDENTITY,
@@ -95,6 +115,8 @@ CREATE TABLE IF NOT EXISTS "estimates" (
 
 	mean					REAL				NOT NULL,
 	std_dev					REAL				NOT NULL,
+	block_size				INTEGER					NULL CHECK (block_size > 0),
+	resamples				INTEGER					NULL CHECK (resamples > 0),
 
 	CONSTRAINT "PK.Estimates_ConfigurationId_TypeId" PRIMARY KEY (configuration_id, type_id),
 	CONSTRAINT "FK.Estimates_ConfigurationId" FOREIGN KEY (configuration_id) REFERENCES "configurations" (configuration_id),
@@ -102,6 +124,9 @@ CREATE TABLE IF NOT EXISTS "estimates" (
 	CONSTRAINT "FK.Estimates_TypeId" FOREIGN KEY (type_id) REFERENCES "types" (type_id)
 );
 
+ALTER TABLE "estimates" ADD COLUMN IF NOT EXISTS block_size INTEGER NULL CHECK (block_size > 0);
+ALTER TABLE "estimates" ADD COLUMN IF NOT EXISTS resamples INTEGER NULL CHECK (resamples > 0);
+
 
 CREATE TABLE IF NOT EXISTS "vortices" (
 	vortex_id				INTEGER				NOT NULL GENERATED ALWAYS AS IDENTITY,
@@ -165,11 +190,17 @@ CREATE TABLE IF NOT EXISTS "chunks" (
 
 	spins					BYTEA				NOT NULL,
 
+	proposal_width			DOUBLE PRECISION	NULL CHECK (proposal_width > 0.0),
+	acceptance				DOUBLE PRECISION	NULL CHECK (acceptance >= 0.0 AND acceptance <= 1.0),
+
 	CONSTRAINT "PK.Chunks_ChunkId" PRIMARY KEY (chunk_id),
 	CONSTRAINT "FK.Chunks_WorkerId" FOREIGN KEY (worker_id) REFERENCES "workers" (worker_id),
 	CONSTRAINT "FK.Chunks_ConfigurationId" FOREIGN KEY (configuration_id) REFERENCES "configurations" (configuration_id)
 );
 
+ALTER TABLE "chunks" ADD COLUMN IF NOT EXISTS proposal_width DOUBLE PRECISION NULL CHECK (proposal_width > 0.0);
+ALTER TABLE "chunks" ADD COLUMN IF NOT EXISTS acceptance DOUBLE PRECISION NULL CHECK (acceptance >= 0.0 AND acceptance <= 1.0);
+
 CREATE UNIQUE INDEX IF NOT EXISTS "IX.Chunks_ConfigurationId_Index" ON "chunks" ("configuration_id", "index");
 
 
@@ -218,9 +249,13 @@ EXECUTE FUNCTION "FNC.RemoveOutdatedEstimates"();
 CREATE OR REPLACE FUNCTION "FNC.OnUpdatedBootstrapResamples"() RETURNS TRIGGER AS
 $BODY$
 BEGIN
-	IF NEW.bootstrap_resamples != OLD.bootstrap_resamples THEN
+	IF NEW.bootstrap_resamples != OLD.bootstrap_resamples OR NEW.bootstrap_tolerance != OLD.bootstrap_tolerance OR NEW.error_estimator != OLD.error_estimator THEN
 		DELETE FROM "estimates" WHERE "configuration_id" IN (
-			SELECT "configuration_id" FROM "configurations" WHERE "simulation_id" = NEW."simulation_id"
+			SELECT c."configuration_id" FROM "configurations" c
+			INNER JOIN "estimates" e ON c.configuration_id = e.configuration_id
+			WHERE c."simulation_id" = NEW."simulation_id" AND (NEW.error_estimator != OLD.error_estimator OR (e.resamples IS NOT NULL AND (
+				NEW.bootstrap_tolerance != OLD.bootstrap_tolerance OR e.resamples > NEW.bootstrap_resamples OR (e.resamples >= OLD.bootstrap_resamples AND NEW.bootstrap_resamples > OLD.bootstrap_resamples)
+			)))
 		);
 	END IF;
 	RETURN NEW;
@@ -266,8 +301,8 @@ PostgresStorage::PostgresStorage(const std::string_view & connection_string) : w
 }
 
 constexpr std::string_view InsertSimulationQuery = R"~~~~~~(
-INSERT INTO "simulations" (simulation_id, bootstrap_resamples, created_at) VALUES ($1, $2, CAST(extract(epoch FROM now()) AS int))
-ON CONFLICT (simulation_id) DO UPDATE SET bootstrap_resamples = $2
+INSERT INTO "simulations" (simulation_id, bootstrap_resamples, error_estimator, bootstrap_tolerance, created_at) VALUES ($1, $2, $3, $4, CAST(extract(epoch FROM now()) AS int))
+ON CONFLICT (simulation_id) DO UPDATE SET bootstrap_resamples = $2, error_estimator = $3, bootstrap_tolerance = $4
 )~~~~~~";
 
 constexpr std::string_view InsertVorticesQuery = R"~~~~~~(
@@ -276,7 +311,7 @@ ON CONFLICT (simulation_id, algorithm, lattice_size) DO NOTHING
 )~~~~~~";
 
 constexpr std::string_view InsertMetadataQuery = R"~~~~~~(
-INSERT INTO "metadata" (simulation_id, algorithm, num_chunks, sweeps_per_chunk) VALUES ($1, $2, $3, $4)
+INSERT INTO "metadata" (simulation_id, algorithm, num_chunks, sweeps_per_chunk, exchange_interval) VALUES ($1, $2, $3, $4, $5)
 ON CONFLICT (simulation_id, algorithm) DO UPDATE SET num_chunks = $3 WHERE "metadata".num_chunks < $3
 )~~~~~~";
 
@@ -305,7 +340,7 @@ FROM configurations c
         WHERE c.simulation_id = $1
         GROUP BY c.configuration_id
     ) e ON c.configuration_id = e.configuration_id
-WHERE c.simulation_id = $1 AND (c2.configuration_id IS NULL OR e.configuration_id IS NULL OR c2.done_chunks < m.num_chunks OR e.done_estimates != CASE WHEN m.algorithm = 0 THEN 8 ELSE 9 END);
+WHERE c.simulation_id = $1 AND (c2.configuration_id IS NULL OR e.configuration_id IS NULL OR c2.done_chunks < m.num_chunks OR e.done_estimates != CASE WHEN m.algorithm = 1 THEN 9 ELSE 8 END);
 )~~~~~~";
 
 constexpr std::string_view FetchMaxDepthQuery = R"~~~~~~(
@@ -334,7 +369,9 @@ bool PostgresStorage::prepare_simulation(const Config config) {
 
 			transaction.exec(InsertSimulationQuery.data(), {
 				config.simulation_id,
-				config.bootstrap_resamples
+				config.bootstrap_resamples,
+				static_cast<int>(config.error_estimator),
+				config.bootstrap_tolerance
 			});
 
 			for (const auto size : config.vortex_sizes) {
@@ -344,7 +381,7 @@ bool PostgresStorage::prepare_simulation(const Config config) {
 
 			for (const auto & [key, value] : config.algorithms) {
 				transaction.exec(pqxx::prepped { "insert_metadata" }, {
-					config.simulation_id, static_cast<int>(key), value.num_chunks, value.sweeps_per_chunk,
+					config.simulation_id, static_cast<int>(key), value.num_chunks, value.sweeps_per_chunk, value.exchange_interval
 				});
 
 				const auto [metadata_id] = transaction.query1<int>(FetchMetadataQuery.data(), {
@@ -482,14 +519,14 @@ void PostgresStorage::save_vortices(const std::size_t vortex_id, std::vector<std
 
 constexpr std::string_view NextChunkQuery = R"~~~~~~(
 WITH selected AS (
-	SELECT c.configuration_id, c.completed_chunks + 1 AS "index", m.algorithm, c.lattice_size, c.temperature, m.sweeps_per_chunk, k.spins
+	SELECT c.configuration_id, c.completed_chunks + 1 AS "index", m.algorithm, c.lattice_size, c.temperature, m.sweeps_per_chunk, k.spins, k.proposal_width
 	FROM simulations s
 	INNER JOIN configurations c on s.simulation_id = c.simulation_id
 	INNER JOIN metadata m ON c.metadata_id = m.metadata_id
 	LEFT JOIN chunks k ON c.configuration_id = k.configuration_id AND c.completed_chunks = k."index"
 	WHERE s.simulation_id = $1 AND (c.active_worker_id IS NULL OR c.active_worker_id IN (
 		SELECT "worker_id" FROM "workers" WHERE "last_active_at" < CAST(extract(epoch FROM now() - INTERVAL '5 minutes') AS int)
-	)) AND c.completed_chunks < m.num_chunks
+	)) AND c.completed_chunks < m.num_chunks AND m.exchange_interval = 0
 	ORDER BY c.completed_chunks ASC, c.lattice_size DESC LIMIT 1
 	FOR UPDATE OF s, c, m
 )
@@ -502,13 +539,13 @@ std::optional<Chunk> PostgresStorage::next_chunk(const int simulation_id) {
 	while (true) {
 		try {
 			pqxx::transaction<pqxx::repeatable_read> transaction { db };
-			const auto configuration_id_opt = transaction.query01<int, int, int, int, double_t, int, std::optional<std::basic_string<std::byte>>>(NextChunkQuery.data(), {
+			const auto configuration_id_opt = transaction.query01<int, int, int, int, double_t, int, std::optional<std::basic_string<std::byte>>, std::optional<double_t>>(NextChunkQuery.data(), {
 				simulation_id, worker_id
 			});
 			transaction.commit();
 
 			if (!configuration_id_opt.has_value()) return std::nullopt;
-			const auto [configuration_id, index, algorithm, lattice_size, temperature, sweeps_per_chunk, spins_opt] = *configuration_id_opt;
+			const auto [configuration_id, index, algorithm, lattice_size, temperature, sweeps_per_chunk, spins_opt, proposal_width] = *configuration_id_opt;
 
 			std::optional<std::vector<double_t>> spins = std::nullopt;
 			if (const auto data = spins_opt) {
@@ -522,7 +559,8 @@ std::optional<Chunk> PostgresStorage::next_chunk(const int simulation_id) {
 				static_cast<std::size_t>(lattice_size),
 				temperature,
 				static_cast<std::size_t>(sweeps_per_chunk),
-				spins
+				spins,
+				proposal_width
 			});
 
 		} catch (const pqxx::serialization_failure &) {
@@ -535,8 +573,131 @@ std::optional<Chunk> PostgresStorage::next_chunk(const int simulation_id) {
 	}
 }
 
+constexpr std::string_view NextSiblingsQuery = R"~~~~~~(
+WITH selected AS (
+	SELECT c.configuration_id, c.completed_chunks + 1 AS "index", m.algorithm, c.lattice_size, c.temperature, m.sweeps_per_chunk, k.spins, k.proposal_width
+	FROM configurations o
+	INNER JOIN configurations c ON c.simulation_id = o.simulation_id AND c.metadata_id = o.metadata_id AND c.lattice_size = o.lattice_size
+	INNER JOIN metadata m ON c.metadata_id = m.metadata_id
+	LEFT JOIN chunks k ON c.configuration_id = k.configuration_id AND c.completed_chunks = k."index"
+	WHERE o.configuration_id = $1 AND c.configuration_id <> o.configuration_id AND (c.active_worker_id IS NULL OR c.active_worker_id IN (
+		SELECT "worker_id" FROM "workers" WHERE "last_active_at" < CAST(extract(epoch FROM now() - INTERVAL '5 minutes') AS int)
+	)) AND c.completed_chunks < m.num_chunks
+	ORDER BY c.completed_chunks ASC, c.temperature ASC LIMIT $2
+	FOR UPDATE OF c, m
+)
+UPDATE configurations SET active_worker_id = $3
+FROM selected WHERE configurations.configuration_id = selected.configuration_id
+RETURNING selected.*
+)~~~~~~";
+
+std::vector<Chunk> PostgresStorage::next_siblings(const Chunk & chunk, const std::size_t count) {
+	while (true) {
+		try {
+			pqxx::transaction<pqxx::repeatable_read> transaction { db };
+
+			std::vector<Chunk> chunks;
+			for (const auto & [configuration_id, index, algorithm, lattice_size, temperature, sweeps_per_chunk, spins_opt, proposal_width] : transaction.query<int, int, int, int, double_t, int, std::optional<std::basic_string<std::byte>>, std::optional<double_t>>(NextSiblingsQuery.data(), {
+				chunk.configuration_id, static_cast<int>(count), worker_id
+			})) {
+				std::optional<std::vector<double_t>> spins = std::nullopt;
+				if (const auto data = spins_opt) {
+					spins = schemas::deserialize(data->data());
+				}
+
+				chunks.push_back({
+					configuration_id,
+					index,
+					static_cast<algorithms::Algorithm>(algorithm),
+					static_cast<std::size_t>(lattice_size),
+					temperature,
+					static_cast<std::size_t>(sweeps_per_chunk),
+					spins,
+					proposal_width
+				});
+			}
+			transaction.commit();
+			return chunks;
+		} catch (const pqxx::serialization_failure &) {
+			std::cout << "[PostgreSQL] Conflict while fetching sibling chunks. Trying again..." << std::endl;
+			utils::sleep_between(1000, 3000);
+		} catch (const pqxx::sql_error & e) {
+			std::cout << "[PostgreSQL] Failed to fetch sibling chunks. PostgreSQL exception: " << e.what() << std::endl;
+			std::rethrow_exception(std::current_exception());
+		}
+	}
+}
+
+constexpr std::string_view NextReplicasQuery = R"~~~~~~(
+WITH selected AS (
+	SELECT c.configuration_id, c.completed_chunks + 1 AS "index", m.algorithm, c.lattice_size, c.temperature, m.sweeps_per_chunk, k.spins, k.proposal_width, m.exchange_interval
+	FROM configurations c
+	INNER JOIN metadata m ON c.metadata_id = m.metadata_id
+	INNER JOIN (
+		SELECT c.metadata_id, c.lattice_size, MIN(c.completed_chunks) AS completed_chunks
+		FROM configurations c
+		INNER JOIN metadata m ON c.metadata_id = m.metadata_id
+		WHERE c.simulation_id = $1 AND m.exchange_interval > 0 AND c.completed_chunks < m.num_chunks
+		GROUP BY c.metadata_id, c.lattice_size
+		HAVING bool_and(c.active_worker_id IS NULL OR c.active_worker_id IN (
+			SELECT "worker_id" FROM "workers" WHERE "last_active_at" < CAST(extract(epoch FROM now() - INTERVAL '5 minutes') AS int)
+		))
+		ORDER BY MIN(c.completed_chunks) ASC, c.lattice_size DESC LIMIT 1
+	) g ON c.metadata_id = g.metadata_id AND c.lattice_size = g.lattice_size AND c.completed_chunks = g.completed_chunks
+	LEFT JOIN chunks k ON c.configuration_id = k.configuration_id AND c.completed_chunks = k."index"
+	WHERE c.simulation_id = $1
+	FOR UPDATE OF c, m
+), updated AS (
+	UPDATE configurations SET active_worker_id = $2
+	FROM selected WHERE configurations.configuration_id = selected.configuration_id
+	RETURNING selected.*
+)
+SELECT * FROM updated ORDER BY temperature ASC
+)~~~~~~";
+
+std::optional<std::tuple<std::size_t, std::vector<Chunk>>> PostgresStorage::next_replicas(const int simulation_id) {
+	while (true) {
+		try {
+			pqxx::transaction<pqxx::repeatable_read> transaction { db };
+
+			std::size_t exchange_interval = 0;
+			std::vector<Chunk> chunks;
+			for (const auto & [configuration_id, index, algorithm, lattice_size, temperature, sweeps_per_chunk, spins_opt, proposal_width, interval] : transaction.query<int, int, int, int, double_t, int, std::optional<std::basic_string<std::byte>>, std::optional<double_t>, int>(NextReplicasQuery.data(), {
+				simulation_id, worker_id
+			})) {
+				std::optional<std::vector<double_t>> spins = std::nullopt;
+				if (const auto data = spins_opt) {
+					spins = schemas::deserialize(data->data());
+				}
+
+				exchange_interval = static_cast<std::size_t>(interval);
+				chunks.push_back({
+					configuration_id,
+					index,
+					static_cast<algorithms::Algorithm>(algorithm),
+					static_cast<std::size_t>(lattice_size),
+					temperature,
+					static_cast<std::size_t>(sweeps_per_chunk),
+					spins,
+					proposal_width
+				});
+			}
+			transaction.commit();
+
+			if (chunks.empty()) return std::nullopt;
+			return std::make_tuple(exchange_interval, chunks);
+		} catch (const pqxx::serialization_failure &) {
+			std::cout << "[PostgreSQL] Conflict while fetching next replicas. Trying again..." << std::endl;
+			utils::sleep_between(1000, 3000);
+		} catch (const pqxx::sql_error & e) {
+			std::cout << "[PostgreSQL] Failed to fetch next replicas. PostgreSQL exception: " << e.what() << std::endl;
+			std::rethrow_exception(std::current_exception());
+		}
+	}
+}
+
 constexpr std::string_view InsertChunkQuery = R"~~~~~~(
-INSERT INTO "chunks" (configuration_id, "index", worker_id, thread_num, start_time, end_time, spins) VALUES ($1, $2, $3, $4, $5, $6, $7) RETURNING chunk_id
+INSERT INTO "chunks" (configuration_id, "index", worker_id, thread_num, start_time, end_time, spins, proposal_width, acceptance) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9) RETURNING chunk_id
 )~~~~~~";
 
 constexpr std::string_view InsertAutocorrelationQuery = R"~~~~~~(
@@ -551,12 +712,15 @@ constexpr std::string_view RemoveWorkerQuery = R"~~~~~~(
 UPDATE "configurations" SET active_worker_id = NULL WHERE "configuration_id" = $1 AND "active_worker_id" = $2
 )~~~~~~";
 
-void PostgresStorage::save_chunk(const Chunk & chunk, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const std::span<const uint8_t> & spins, const std::map<observables::Type, std::tuple<double_t, std::vector<uint8_t>, std::optional<std::vector<uint8_t>>>> & results) {
+void PostgresStorage::save_chunk(const Chunk & chunk, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const std::span<const uint8_t> & spins, const std::optional<std::tuple<double_t, double_t>> & proposal, const std::map<observables::Type, std::tuple<double_t, std::vector<uint8_t>, std::optional<std::vector<uint8_t>>>> & results) {
 	try {
 		pqxx::work transaction { db };
 
+		const auto proposal_width = proposal.transform([] (const auto & window) { return get<0>(window); });
+		const auto acceptance = proposal.transform([] (const auto & window) { return get<1>(window); });
 		const auto [chunk_id] = transaction.query1<int>(InsertChunkQuery.data(), {
-			chunk.configuration_id, chunk.index, worker_id, thread_num, start_time, end_time, pqxx::binary_cast(spins.data(), spins.size())
+			chunk.configuration_id, chunk.index, worker_id, thread_num, start_time, end_time, pqxx::binary_cast(spins.data(), spins.size()),
+			proposal_width, acceptance
 		});
 
 		db.prepare("result", InsertResultQuery.data());
@@ -586,7 +750,7 @@ void PostgresStorage::save_chunk(const Chunk & chunk, const int32_t thread_num,
 
 constexpr std::string_view FetchNextEstimateQuery = R"~~~~~~(
 WITH selected AS (
-	SELECT c.configuration_id, s.bootstrap_resamples, m.num_chunks, t.type_id
+	SELECT c.configuration_id, s.bootstrap_resamples, m.num_chunks, t.type_id, s.error_estimator, s.bootstrap_tolerance
 	FROM "simulations" s
 	INNER JOIN "configurations" c ON c.simulation_id = s.simulation_id
 	INNER JOIN "metadata" m ON c.metadata_id = m.metadata_id
@@ -616,7 +780,7 @@ std::optional<std::tuple<Estimate, std::vector<double_t>>> PostgresStorage::next
 		try {
 			pqxx::transaction<pqxx::repeatable_read> transaction { db };
 
-			const auto estimate_opt = transaction.query01<int, std::size_t, int, int>(FetchNextEstimateQuery.data(), {
+			const auto estimate_opt = transaction.query01<int, std::size_t, int, int, int, double_t>(FetchNextEstimateQuery.data(), {
 				simulation_id, worker_id
 			});
 
@@ -624,7 +788,7 @@ std::optional<std::tuple<Estimate, std::vector<double_t>>> PostgresStorage::next
 				return std::nullopt;
 			}
 
-			const auto [configuration_id, bootstrap_resamples, num_chunks, type] = *estimate_opt;
+			const auto [configuration_id, bootstrap_resamples, num_chunks, type, error_estimator, bootstrap_tolerance] = *estimate_opt;
 			transaction.commit();
 
 			pqxx::work work { db };
@@ -639,7 +803,7 @@ std::optional<std::tuple<Estimate, std::vector<double_t>>> PostgresStorage::next
 
 			work.commit();
 
-			return { std::make_tuple<Estimate, std::vector<double_t>>({ configuration_id, static_cast<observables::Type>(type), bootstrap_resamples }, std::move(values)) };
+			return { std::make_tuple<Estimate, std::vector<double_t>>({ configuration_id, static_cast<observables::Type>(type), bootstrap_resamples, bootstrap_tolerance, static_cast<analysis::ErrorEstimator>(error_estimator) }, std::move(values)) };
 		} catch (const pqxx::serialization_failure &) {
 			std::cout << "[PostgreSQL] Conflict while fetching next estimate. Trying again..." << std::endl;
 			utils::sleep_between(1000, 3000);
@@ -651,15 +815,15 @@ std::optional<std::tuple<Estimate, std::vector<double_t>>> PostgresStorage::next
 }
 
 constexpr std::string_view InsertEstimateQuery = R"~~~~~~(
-INSERT INTO "estimates" (configuration_id, type_id, worker_id, thread_num, start_time, end_time, mean, std_dev) VALUES ($1, $2, $3, $4, $5, $6, $7, $8)
+INSERT INTO "estimates" (configuration_id, type_id, worker_id, thread_num, start_time, end_time, mean, std_dev, block_size, resamples) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10)
 )~~~~~~";
 
-void PostgresStorage::save_estimate(const int configuration_id, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const observables::Type type, const double_t mean, const double_t std_dev) {
+void PostgresStorage::save_estimate(const int configuration_id, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const observables::Type type, const double_t mean, const double_t std_dev, const std::optional<std::size_t> block_size, const std::optional<std::size_t> resamples) {
 	try {
 		pqxx::work transaction { db };
 
 		transaction.exec(InsertEstimateQuery.data(), {
-			configuration_id, static_cast<int>(type), worker_id, thread_num, start_time, end_time, mean, std_dev
+			configuration_id, static_cast<int>(type), worker_id, thread_num, start_time, end_time, mean, std_dev, block_size.transform([] (const auto x) { return static_cast<int>(x); }), resamples.transform([] (const auto x) { return static_cast<int>(x); })
 		});
 
 		transaction.exec(RemoveWorkerQuery.data(), {
@@ -673,6 +837,102 @@ void PostgresStorage::save_estimate(const int configuration_id, const int32_t th
 	}
 }
 
+constexpr std::string_view FetchNextJointEstimateQuery = R"~~~~~~(
+WITH selected AS (
+	SELECT c.configuration_id, c.temperature, s.bootstrap_resamples, m.num_chunks, s.error_estimator, s.bootstrap_tolerance
+	FROM "simulations" s
+	INNER JOIN "configurations" c ON c.simulation_id = s.simulation_id
+	INNER JOIN "metadata" m ON c.metadata_id = m.metadata_id
+	INNER JOIN "chunks" ch ON c.configuration_id = ch.configuration_id AND ch."index" = m.num_chunks
+	WHERE s.simulation_id = $1 AND c.completed_chunks = m.num_chunks AND (c.active_worker_id IS NULL OR c.active_worker_id IN (
+		SELECT "worker_id" FROM "workers" WHERE "last_active_at" < CAST(extract(epoch FROM now() - INTERVAL '5 minutes') AS int)
+	)) AND EXISTS (
+		SELECT 1 FROM "types" t
+		LEFT JOIN "estimates" e ON e.configuration_id = c.configuration_id AND e.type_id = t.type_id
+		WHERE e.type_id IS NULL AND (t.type_id BETWEEN 0 AND 7 OR (t.type_id = 8 AND m.algorithm = 1))
+	)
+	LIMIT 1 FOR UPDATE OF s, c, m, ch
+)
+UPDATE configurations SET active_worker_id = $2
+FROM selected WHERE configurations.configuration_id = selected.configuration_id
+RETURNING selected.*
+)~~~~~~";
+
+constexpr std::string_view FetchAllConfigurationResults = R"~~~~~~(
+SELECT r.type_id, r.data
+FROM "chunks" c
+INNER JOIN "results" r ON c.chunk_id = r.chunk_id
+WHERE c.configuration_id = $1
+ORDER BY r.type_id, c."index"
+)~~~~~~";
+
+std::optional<std::tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>>> PostgresStorage::next_joint_estimate(const int simulation_id) {
+	while (true) {
+		try {
+			pqxx::transaction<pqxx::repeatable_read> transaction { db };
+
+			const auto estimate_opt = transaction.query01<int, double_t, std::size_t, int, int, double_t>(FetchNextJointEstimateQuery.data(), {
+				simulation_id, worker_id
+			});
+
+			if (!estimate_opt.has_value()) {
+				return std::nullopt;
+			}
+
+			const auto [configuration_id, temperature, bootstrap_resamples, num_chunks, error_estimator, bootstrap_tolerance] = *estimate_opt;
+			transaction.commit();
+
+			pqxx::work work { db };
+
+			std::map<observables::Type, std::vector<double_t>> values {};
+			for (const auto & [type, buffer] : work.query<int, std::basic_string<std::byte>>(FetchAllConfigurationResults.data(), { configuration_id })) {
+				const auto data = schemas::deserialize(buffer.data());
+
+				auto & series = values[static_cast<observables::Type>(type)];
+				series.reserve(data.size() * num_chunks);
+				series.insert(series.end(), data.begin(), data.end());
+			}
+
+			work.commit();
+
+			return { std::make_tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>>({ configuration_id, temperature, bootstrap_resamples, bootstrap_tolerance, static_cast<analysis::ErrorEstimator>(error_estimator) }, std::move(values)) };
+		} catch (const pqxx::serialization_failure &) {
+			std::cout << "[PostgreSQL] Conflict while fetching next joint estimate. Trying again..." << std::endl;
+			utils::sleep_between(1000, 3000);
+		}  catch (std::exception & e) {
+			std::cout << "[PostgreSQL] Failed to fetch next joint estimate. PostgreSQL exception: " << e.what() << std::endl;
+			std::rethrow_exception(std::current_exception());
+		}
+	}
+}
+
+constexpr std::string_view UpsertEstimateQuery = R"~~~~~~(
+INSERT INTO "estimates" (configuration_id, type_id, worker_id, thread_num, start_time, end_time, mean, std_dev, block_size, resamples) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10)
+ON CONFLICT (configuration_id, type_id) DO UPDATE SET worker_id = excluded.worker_id, thread_num = excluded.thread_num, start_time = excluded.start_time, end_time = excluded.end_time, mean = excluded.mean, std_dev = excluded.std_dev, block_size = excluded.block_size, resamples = excluded.resamples
+)~~~~~~";
+
+void PostgresStorage::save_estimates(const int configuration_id, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const analysis::Estimates & estimates) {
+	try {
+		pqxx::work transaction { db };
+
+		for (const auto & [type, estimate] : estimates) {
+			const auto [mean, std_dev, block_size, resamples] = estimate;
+			transaction.exec(UpsertEstimateQuery.data(), {
+				configuration_id, static_cast<int>(type), worker_id, thread_num, start_time, end_time, mean, std_dev, block_size.transform([] (const auto x) { return static_cast<int>(x); }), resamples.transform([] (const auto x) { return static_cast<int>(x); })
+			});
+		}
+
+		transaction.exec(RemoveWorkerQuery.data(), {
+			configuration_id, worker_id,
+		});
+
+		transaction.commit();
+	} catch (const std::exception & e) {
+		std::cout << "[PostgreSQL] Failed to save estimates. PostgreSQL exception: " << e.what() << std::endl;
+		std::rethrow_exception(std::current_exception());
+	}
+}
+
 constexpr std::string_view FetchNextDerivativeQuery = R"~~~~~~(
 WITH selected AS (
 	SELECT e.configuration_id, e.type_id, c.temperature, e.mean, e.std_dev, o.mean, o.std_dev
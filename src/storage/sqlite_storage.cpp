@@ -5,6 +5,7 @@
 #include "storage/sqlite_storage.hpp"
 
 #include <thread>
+#include <tuple>
 
 #include "schemas/serialize.hpp"
 
@@ -13,6 +14,8 @@ CREATE TABLE IF NOT EXISTS "simulations" (
 	simulation_id			INTEGER				NOT NULL,
 
 	bootstrap_resamples		INTEGER				NOT NULL DEFAULT (100000) CHECK (bootstrap_resamples > 0),
+	bootstrap_tolerance		REAL				NOT NULL DEFAULT (0.0) CHECK (bootstrap_tolerance >= 0.0),
+	error_estimator			INTEGER				NOT NULL DEFAULT (0) CHECK (error_estimator = 0 OR error_estimator = 1),
 	created_at				BIGINT				NOT NULL,
 
 	CONSTRAINT "PK.Simulations_SimulationId" PRIMARY KEY (simulation_id)
@@ -23,9 +26,10 @@ CREATE TABLE IF NOT EXISTS "metadata" (
 	metadata_id				INTEGER				NOT NULL,
 
 	simulation_id			INTEGER				NOT NULL,
-	algorithm				INTEGER				NOT NULL CHECK (algorithm = 0 OR algorithm = 1),
+	algorithm				INTEGER				NOT NULL CHECK (algorithm = 0 OR algorithm = 1 OR algorithm = 2 OR algorithm = 3),
 	num_chunks				INTEGER				NOT NULL DEFAULT (10) CHECK (num_chunks > 0),
 	sweeps_per_chunk		INTEGER				NOT NULL DEFAULT (100000) CHECK (sweeps_per_chunk > 0),
+	exchange_interval		INTEGER				NOT NULL DEFAULT (0) CHECK (exchange_interval >= 0),
 
 	CONSTRAINT "PK.Metadata_SimulationId" PRIMARY KEY (metadata_id),
 	CONSTRAINT "FK.Metadata_SimulationId" FOREIGN KEY (simulation_id) REFERENCES "simulations" (simulation_id)
@@ -95,6 +99,8 @@ CREATE TABLE IF NOT EXISTS "estimates" (
 
 	mean					REAL				NOT NULL,
 	std_dev					REAL				NOT NULL,
+	block_size				INTEGER					NULL CHECK (block_size > 0),
+	resamples				INTEGER					NULL CHECK (resamples > 0),
 
 	CONSTRAINT "PK.Estimates_ConfigurationId_TypeId" PRIMARY KEY (configuration_id, type_id),
 	CONSTRAINT "FK.Estimates_ConfigurationId" FOREIGN KEY (configuration_id) REFERENCES "configurations" (configuration_id),
@@ -158,6 +164,9 @@ CREATE TABLE IF NOT EXISTS "chunks" (
 
 	spins					BLOB				NOT NULL,
 
+	proposal_width			REAL				NULL CHECK (proposal_width > 0.0),
+	acceptance				REAL				NULL CHECK (acceptance >= 0.0 AND acceptance <= 1.0),
+
 	CONSTRAINT "PK.Chunks_ChunkId" PRIMARY KEY (chunk_id),
 	CONSTRAINT "FK.Chunks_ConfigurationId" FOREIGN KEY (configuration_id) REFERENCES "configurations" (configuration_id),
 	CONSTRAINT "FK.Chunks_WokerId" FOREIGN KEY (worker_id) REFERENCES "workers" (worker_id)
@@ -202,11 +211,17 @@ BEGIN
 	);
 END;
 
-CREATE TRIGGER IF NOT EXISTS "TRG.OnUpdatedBootstrapResamples"
-AFTER UPDATE ON "simulations" FOR EACH ROW WHEN NEW.bootstrap_resamples != OLD.bootstrap_resamples
+-- Recreated, since databases created before the tolerance and the error estimator still have the trigger that drops every estimate
+DROP TRIGGER IF EXISTS "TRG.OnUpdatedBootstrapResamples";
+CREATE TRIGGER "TRG.OnUpdatedBootstrapResamples"
+AFTER UPDATE ON "simulations" FOR EACH ROW WHEN NEW.bootstrap_resamples != OLD.bootstrap_resamples OR NEW.bootstrap_tolerance != OLD.bootstrap_tolerance OR NEW.error_estimator != OLD.error_estimator
 BEGIN
 	DELETE FROM "estimates" WHERE "configuration_id" IN (
-		SELECT "configuration_id" FROM "configurations" WHERE "simulation_id" = NEW."simulation_id"
+		SELECT c."configuration_id" FROM "configurations" c
+		INNER JOIN "estimates" e ON c.configuration_id = e.configuration_id
+		WHERE c."simulation_id" = NEW."simulation_id" AND (NEW.error_estimator != OLD.error_estimator OR (e.resamples IS NOT NULL AND (
+			NEW.bootstrap_tolerance != OLD.bootstrap_tolerance OR e.resamples > NEW.bootstrap_resamples OR (e.resamples >= OLD.bootstrap_resamples AND NEW.bootstrap_resamples > OLD.bootstrap_resamples)
+		)))
 	);
 END;
 
@@ -217,6 +232,76 @@ BEGIN
 END;
 )~~~~~~";
 
+/**
+ * Finds a metadata table created before heat bath and Swendsen-Wang were added, whose CHECK constraint only admits
+ * Metropolis and Wolff.
+ */
+constexpr std::string_view OutdatedMetadataQuery = R"~~~~~~(
+SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = 'metadata' AND sql NOT LIKE '%algorithm = 3%'
+)~~~~~~";
+
+/**
+ * SQLite cannot alter a constraint, so the metadata table is rebuilt with the current definition and the rows of the old
+ * one. Only the columns of the original table are copied, any newer column starts from its default.
+ */
+constexpr std::string_view RebuildMetadataQuery = R"~~~~~~(
+CREATE TABLE "metadata_new" (
+	metadata_id				INTEGER				NOT NULL,
+
+	simulation_id			INTEGER				NOT NULL,
+	algorithm				INTEGER				NOT NULL CHECK (algorithm = 0 OR algorithm = 1 OR algorithm = 2 OR algorithm = 3),
+	num_chunks				INTEGER				NOT NULL DEFAULT (10) CHECK (num_chunks > 0),
+	sweeps_per_chunk		INTEGER				NOT NULL DEFAULT (100000) CHECK (sweeps_per_chunk > 0),
+	exchange_interval		INTEGER				NOT NULL DEFAULT (0) CHECK (exchange_interval >= 0),
+
+	CONSTRAINT "PK.Metadata_SimulationId" PRIMARY KEY (metadata_id),
+	CONSTRAINT "FK.Metadata_SimulationId" FOREIGN KEY (simulation_id) REFERENCES "simulations" (simulation_id)
+);
+
+INSERT INTO "metadata_new" (metadata_id, simulation_id, algorithm, num_chunks, sweeps_per_chunk, exchange_interval)
+SELECT metadata_id, simulation_id, algorithm, num_chunks, sweeps_per_chunk, exchange_interval FROM "metadata";
+
+DROP TABLE "metadata";
+ALTER TABLE "metadata_new" RENAME TO "metadata";
+
+CREATE UNIQUE INDEX IF NOT EXISTS "IX.Metadata_SimulationId_Algorithm" ON "metadata" (simulation_id, algorithm);
+)~~~~~~";
+
+/**
+ * The columns added to a table after it was first created as (table, column, definition). CREATE TABLE IF NOT EXISTS leaves
+ * the tables of older databases untouched, so every missing column is added separately. SQLite requires a constant default
+ * without parentheses for a column added to a table with rows.
+ */
+constexpr std::tuple<std::string_view, std::string_view, std::string_view> SQLITE_COLUMNS[] = {
+	{ "chunks", "proposal_width", "REAL NULL CHECK (proposal_width > 0.0)" },
+	{ "chunks", "acceptance", "REAL NULL CHECK (acceptance >= 0.0 AND acceptance <= 1.0)" },
+	{ "metadata", "exchange_interval", "INTEGER NOT NULL DEFAULT 0 CHECK (exchange_interval >= 0)" },
+	{ "simulations", "error_estimator", "INTEGER NOT NULL DEFAULT 0 CHECK (error_estimator = 0 OR error_estimator = 1)" },
+	{ "simulations", "bootstrap_tolerance", "REAL NOT NULL DEFAULT 0.0 CHECK (bootstrap_tolerance >= 0.0)" },
+	{ "estimates", "block_size", "INTEGER NULL CHECK (block_size > 0)" },
+	{ "estimates", "resamples", "INTEGER NULL CHECK (resamples > 0)" },
+};
+
+constexpr std::string_view ColumnExistsQuery = R"~~~~~~(
+SELECT COUNT(*) FROM pragma_table_info(@table) WHERE name = @column
+)~~~~~~";
+
+/**
+ * SQLite has no ADD COLUMN IF NOT EXISTS, so each column of SQLITE_COLUMNS is looked up in its table first.
+ */
+static void add_missing_columns(SQLite::Database & db) {
+	SQLite::Statement exists { db, ColumnExistsQuery.data() };
+	for (const auto & [table, column, definition] : SQLITE_COLUMNS) {
+		exists.bind("@table", std::string { table });
+		exists.bind("@column", std::string { column });
+
+		if (exists.executeStep() && exists.getColumn(0).getInt() == 0) {
+			db.exec("ALTER TABLE \"" + std::string { table } + "\" ADD COLUMN " + std::string { column } + " " + std::string { definition });
+		}
+		exists.reset();
+	}
+}
+
 constexpr std::string_view RegisterWorkerQuery = R"~~~~~~(
 INSERT INTO "workers" (name, last_active_at) VALUES (@name, unixepoch('now')) RETURNING "worker_id"
 )~~~~~~";
@@ -224,12 +309,20 @@ INSERT INTO "workers" (name, last_active_at) VALUES (@name, unixepoch('now')) RE
 SQLiteStorage::SQLiteStorage(const std::string_view & path) : worker_id(-1), db(path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE | SQLite::OPEN_NOMUTEX) {
 	try {
 		db.setBusyTimeout(30000);
-		db.exec("PRAGMA foreign_keys = ON");
 		db.exec("PRAGMA synchronous = NORMAL");
 
+		// The foreign keys are only enabled after the migrations, since rebuilding a table drops the one referenced
 		SQLite::Transaction transaction { db, SQLite::TransactionBehavior::IMMEDIATE };
 		db.exec(SQLITE_MIGRATIONS.data());
 
+		// Renaming the rebuilt table checks every trigger, which already refer to the added columns
+		add_missing_columns(db);
+
+		SQLite::Statement outdated { db, OutdatedMetadataQuery.data() };
+		if (outdated.executeStep() && outdated.getColumn(0).getInt() > 0) {
+			db.exec(RebuildMetadataQuery.data());
+		}
+
 		SQLite::Statement worker { db, RegisterWorkerQuery.data() };
 		worker.bind("@name", utils::hostname());
 
@@ -238,6 +331,8 @@ SQLiteStorage::SQLiteStorage(const std::string_view & path) : worker_id(-1), db(
 
 		while (worker.executeStep()) { }
 		transaction.commit();
+
+		db.exec("PRAGMA foreign_keys = ON");
 	} catch (const std::exception &e) {
 		std::cout << "[SQLite] Failed to migrate database. SQLite exception: " << e.what() << std::endl;
 		std::rethrow_exception(std::current_exception());
@@ -245,8 +340,8 @@ SQLiteStorage::SQLiteStorage(const std::string_view & path) : worker_id(-1), db(
 }
 
 constexpr std::string_view InsertSimulationQuery = R"~~~~~~(
-INSERT INTO "simulations" (simulation_id, bootstrap_resamples, created_at) VALUES (@simulation_id, @bootstrap_resamples, unixepoch('now'))
-ON CONFLICT DO UPDATE SET bootstrap_resamples = @bootstrap_resamples
+INSERT INTO "simulations" (simulation_id, bootstrap_resamples, bootstrap_tolerance, error_estimator, created_at) VALUES (@simulation_id, @bootstrap_resamples, @bootstrap_tolerance, @error_estimator, unixepoch('now'))
+ON CONFLICT DO UPDATE SET bootstrap_resamples = @bootstrap_resamples, bootstrap_tolerance = @bootstrap_tolerance, error_estimator = @error_estimator
 )~~~~~~";
 
 constexpr std::string_view InsertVorticesQuery = R"~~~~~~(
@@ -255,7 +350,7 @@ ON CONFLICT DO NOTHING
 )~~~~~~";
 
 constexpr std::string_view InsertMetadataQuery = R"~~~~~~(
-INSERT INTO "metadata" (simulation_id, algorithm, num_chunks, sweeps_per_chunk) VALUES (@simulation_id, @algorithm, @num_chunks, @sweeps_per_chunk)
+INSERT INTO "metadata" (simulation_id, algorithm, num_chunks, sweeps_per_chunk, exchange_interval) VALUES (@simulation_id, @algorithm, @num_chunks, @sweeps_per_chunk, @exchange_interval)
 ON CONFLICT DO UPDATE SET num_chunks = @num_chunks WHERE num_chunks < @num_chunks
 )~~~~~~";
 
@@ -284,7 +379,7 @@ FROM configurations c
         WHERE c.simulation_id = @simulation_id
         GROUP BY c.configuration_id
     ) e ON c.configuration_id = e.configuration_id
-WHERE c.simulation_id = @simulation_id AND (c2.configuration_id IS NULL OR e.configuration_id IS NULL OR c2.done_chunks < m.num_chunks OR e.done_estimates != CASE WHEN m.algorithm = 0 THEN 8 ELSE 9 END);
+WHERE c.simulation_id = @simulation_id AND (c2.configuration_id IS NULL OR e.configuration_id IS NULL OR c2.done_chunks < m.num_chunks OR e.done_estimates != CASE WHEN m.algorithm = 1 THEN 9 ELSE 8 END);
 )~~~~~~";
 
 constexpr std::string_view FetchMaxDepthQuery = R"~~~~~~(
@@ -309,6 +404,8 @@ bool SQLiteStorage::prepare_simulation(const Config config) {
 		SQLite::Statement simulation { db, InsertSimulationQuery.data() };
 		simulation.bind("@simulation_id", config.simulation_id);
 		simulation.bind("@bootstrap_resamples", static_cast<int>(config.bootstrap_resamples));
+		simulation.bind("@bootstrap_tolerance", config.bootstrap_tolerance);
+		simulation.bind("@error_estimator", config.error_estimator);
 		simulation.exec();
 
 		SQLite::Statement vortex { db, InsertVorticesQuery.data() };
@@ -335,6 +432,7 @@ bool SQLiteStorage::prepare_simulation(const Config config) {
 			insert_metadata.bind("@algorithm", key);
 			insert_metadata.bind("@num_chunks", static_cast<int>(value.num_chunks));
 			insert_metadata.bind("@sweeps_per_chunk", static_cast<int>(value.sweeps_per_chunk));
+			insert_metadata.bind("@exchange_interval", static_cast<int>(value.exchange_interval));
 
 			insert_metadata.exec();
 			insert_metadata.reset();
@@ -499,18 +597,18 @@ void SQLiteStorage::save_vortices(const std::size_t vortex_id, std::vector<std::
 }
 
 constexpr std::string_view NextChunkQuery = R"~~~~~~(
-SELECT c.configuration_id, IfNull(k.num_chunks, 0) + 1 AS "index", m.algorithm, c.lattice_size, c.temperature, m.sweeps_per_chunk, k.spins
+SELECT c.configuration_id, IfNull(k.num_chunks, 0) + 1 AS "index", m.algorithm, c.lattice_size, c.temperature, m.sweeps_per_chunk, k.spins, k.proposal_width
 FROM simulations s
 INNER JOIN configurations c on s.simulation_id = c.simulation_id
 INNER JOIN metadata m ON c.metadata_id = m.metadata_id
 LEFT JOIN (
-    SELECT k.configuration_id, k.spins, MAX(k."index") AS num_chunks
+    SELECT k.configuration_id, k.spins, k.proposal_width, MAX(k."index") AS num_chunks
     FROM chunks k
 	GROUP BY k.configuration_id
 ) k ON c.configuration_id = k.configuration_id
 WHERE s.simulation_id = @simulation_id AND (c.active_worker_id IS NULL OR c.active_worker_id IN (
 	SELECT "worker_id" FROM "workers" WHERE "last_active_at" < unixepoch('now', '-5 minutes')
-)) AND IfNull(k.num_chunks, 0) < m.num_chunks
+)) AND IfNull(k.num_chunks, 0) < m.num_chunks AND m.exchange_interval = 0
 ORDER BY IfNull(k.num_chunks, 0) ASC, c.lattice_size DESC LIMIT 1
 )~~~~~~";
 
@@ -548,7 +646,8 @@ std::optional<Chunk> SQLiteStorage::next_chunk(const int simulation_id) {
 			static_cast<std::size_t>(next_chunk.getColumn(3).getInt()),
 			next_chunk.getColumn(4).getDouble(),
 			static_cast<std::size_t>(next_chunk.getColumn(5).getInt()),
-			spins
+			spins,
+			next_chunk.getColumn(7).isNull() ? std::nullopt : std::optional(next_chunk.getColumn(7).getDouble())
 		});
 
 	} catch (std::exception & e) {
@@ -557,8 +656,128 @@ std::optional<Chunk> SQLiteStorage::next_chunk(const int simulation_id) {
 	}
 }
 
+constexpr std::string_view NextSiblingsQuery = R"~~~~~~(
+SELECT c.configuration_id, c.completed_chunks + 1 AS "index", m.algorithm, c.lattice_size, c.temperature, m.sweeps_per_chunk, k.spins, k.proposal_width
+FROM configurations o
+INNER JOIN configurations c ON c.simulation_id = o.simulation_id AND c.metadata_id = o.metadata_id AND c.lattice_size = o.lattice_size
+INNER JOIN metadata m ON c.metadata_id = m.metadata_id
+LEFT JOIN chunks k ON c.configuration_id = k.configuration_id AND c.completed_chunks = k."index"
+WHERE o.configuration_id = @configuration_id AND c.configuration_id <> o.configuration_id AND (c.active_worker_id IS NULL OR c.active_worker_id IN (
+	SELECT "worker_id" FROM "workers" WHERE "last_active_at" < unixepoch('now', '-5 minutes')
+)) AND c.completed_chunks < m.num_chunks
+ORDER BY c.completed_chunks ASC, c.temperature ASC LIMIT @count
+)~~~~~~";
+
+std::vector<Chunk> SQLiteStorage::next_siblings(const Chunk & chunk, const std::size_t count) {
+	try {
+		SQLite::Transaction transaction { db, SQLite::TransactionBehavior::IMMEDIATE };
+
+		SQLite::Statement next_siblings { db, NextSiblingsQuery.data() };
+		next_siblings.bind("@configuration_id", chunk.configuration_id);
+		next_siblings.bind("@count", static_cast<int64_t>(count));
+
+		SQLite::Statement worker { db, SetConfigurationActiveWorker.data() };
+
+		std::vector<Chunk> chunks;
+		while (next_siblings.executeStep()) {
+			worker.bind("@configuration_id", next_siblings.getColumn(0).getInt());
+			worker.bind("@worker_id", worker_id);
+			worker.exec();
+			worker.reset();
+
+			std::optional<std::vector<double_t>> spins = std::nullopt;
+			if (!next_siblings.getColumn(6).isNull()) {
+				const auto buffer = next_siblings.getColumn(6).getBlob();
+				spins = schemas::deserialize(buffer);
+			}
+
+			chunks.push_back({
+				next_siblings.getColumn(0).getInt(),
+				next_siblings.getColumn(1).getInt(),
+				static_cast<algorithms::Algorithm>(next_siblings.getColumn(2).getInt()),
+				static_cast<std::size_t>(next_siblings.getColumn(3).getInt()),
+				next_siblings.getColumn(4).getDouble(),
+				static_cast<std::size_t>(next_siblings.getColumn(5).getInt()),
+				spins,
+				next_siblings.getColumn(7).isNull() ? std::nullopt : std::optional(next_siblings.getColumn(7).getDouble())
+			});
+		}
+
+		transaction.commit();
+		return chunks;
+	} catch (std::exception & e) {
+		std::cout << "[SQLite] Failed to fetch sibling chunks. SQLite exception: " << e.what() << std::endl;
+		std::rethrow_exception(std::current_exception());
+	}
+}
+
+constexpr std::string_view NextReplicasQuery = R"~~~~~~(
+SELECT c.configuration_id, c.completed_chunks + 1 AS "index", m.algorithm, c.lattice_size, c.temperature, m.sweeps_per_chunk, k.spins, k.proposal_width, m.exchange_interval
+FROM configurations c
+INNER JOIN metadata m ON c.metadata_id = m.metadata_id
+INNER JOIN (
+	SELECT c.metadata_id, c.lattice_size, MIN(c.completed_chunks) AS completed_chunks
+	FROM configurations c
+	INNER JOIN metadata m ON c.metadata_id = m.metadata_id
+	WHERE c.simulation_id = @simulation_id AND m.exchange_interval > 0 AND c.completed_chunks < m.num_chunks
+	GROUP BY c.metadata_id, c.lattice_size
+	HAVING MIN(c.active_worker_id IS NULL OR c.active_worker_id IN (
+		SELECT "worker_id" FROM "workers" WHERE "last_active_at" < unixepoch('now', '-5 minutes')
+	)) = 1
+	ORDER BY MIN(c.completed_chunks) ASC, c.lattice_size DESC LIMIT 1
+) g ON c.metadata_id = g.metadata_id AND c.lattice_size = g.lattice_size AND c.completed_chunks = g.completed_chunks
+LEFT JOIN chunks k ON c.configuration_id = k.configuration_id AND c.completed_chunks = k."index"
+WHERE c.simulation_id = @simulation_id
+ORDER BY c.temperature ASC
+)~~~~~~";
+
+std::optional<std::tuple<std::size_t, std::vector<Chunk>>> SQLiteStorage::next_replicas(const int simulation_id) {
+	try {
+		SQLite::Transaction transaction { db, SQLite::TransactionBehavior::IMMEDIATE };
+
+		SQLite::Statement next_replicas { db, NextReplicasQuery.data() };
+		next_replicas.bind("@simulation_id", simulation_id);
+
+		SQLite::Statement worker { db, SetConfigurationActiveWorker.data() };
+
+		std::size_t exchange_interval = 0;
+		std::vector<Chunk> chunks;
+		while (next_replicas.executeStep()) {
+			worker.bind("@configuration_id", next_replicas.getColumn(0).getInt());
+			worker.bind("@worker_id", worker_id);
+			worker.exec();
+			worker.reset();
+
+			std::optional<std::vector<double_t>> spins = std::nullopt;
+			if (!next_replicas.getColumn(6).isNull()) {
+				const auto buffer = next_replicas.getColumn(6).getBlob();
+				spins = schemas::deserialize(buffer);
+			}
+
+			exchange_interval = static_cast<std::size_t>(next_replicas.getColumn(8).getInt());
+			chunks.push_back({
+				next_replicas.getColumn(0).getInt(),
+				next_replicas.getColumn(1).getInt(),
+				static_cast<algorithms::Algorithm>(next_replicas.getColumn(2).getInt()),
+				static_cast<std::size_t>(next_replicas.getColumn(3).getInt()),
+				next_replicas.getColumn(4).getDouble(),
+				static_cast<std::size_t>(next_replicas.getColumn(5).getInt()),
+				spins,
+				next_replicas.getColumn(7).isNull() ? std::nullopt : std::optional(next_replicas.getColumn(7).getDouble())
+			});
+		}
+
+		if (chunks.empty()) return std::nullopt;
+		transaction.commit();
+		return std::make_tuple(exchange_interval, chunks);
+	} catch (std::exception & e) {
+		std::cout << "[SQLite] Failed to fetch next replicas. SQLite exception: " << e.what() << std::endl;
+		std::rethrow_exception(std::current_exception());
+	}
+}
+
 constexpr std::string_view InsertChunkQuery = R"~~~~~~(
-INSERT INTO "chunks" (configuration_id, "index", worker_id, thread_num, start_time, end_time, spins) VALUES (@configuration_id, @index, @worker_id, @thread_num, @start_time, @end_time, @spins) RETURNING chunk_id
+INSERT INTO "chunks" (configuration_id, "index", worker_id, thread_num, start_time, end_time, spins, proposal_width, acceptance) VALUES (@configuration_id, @index, @worker_id, @thread_num, @start_time, @end_time, @spins, @proposal_width, @acceptance) RETURNING chunk_id
 )~~~~~~";
 
 constexpr std::string_view InsertAutocorrelationQuery = R"~~~~~~(
@@ -573,7 +792,7 @@ constexpr std::string_view RemoveWorkerQuery = R"~~~~~~(
 UPDATE "configurations" SET active_worker_id = NULL WHERE "configuration_id" = @configuration_id AND "active_worker_id" = @worker_id
 )~~~~~~";
 
-void SQLiteStorage::save_chunk(const Chunk & chunk, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const std::span<const uint8_t> & spins, const std::map<observables::Type, std::tuple<double_t, std::vector<uint8_t>, std::optional<std::vector<uint8_t>>>> & results) {
+void SQLiteStorage::save_chunk(const Chunk & chunk, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const std::span<const uint8_t> & spins, const std::optional<std::tuple<double_t, double_t>> & proposal, const std::map<observables::Type, std::tuple<double_t, std::vector<uint8_t>, std::optional<std::vector<uint8_t>>>> & results) {
 	try {
 		SQLite::Transaction transaction { db, SQLite::TransactionBehavior::IMMEDIATE };
 
@@ -585,6 +804,13 @@ void SQLiteStorage::save_chunk(const Chunk & chunk, const int32_t thread_num, co
 		chunk_stmt.bind("@start_time", start_time);
 		chunk_stmt.bind("@end_time", end_time);
 		chunk_stmt.bind("@spins", spins.data(), static_cast<int>(spins.size()));
+		if (const auto window = proposal) {
+			chunk_stmt.bind("@proposal_width", get<0>(*window));
+			chunk_stmt.bind("@acceptance", get<1>(*window));
+		} else {
+			chunk_stmt.bind("@proposal_width");
+			chunk_stmt.bind("@acceptance");
+		}
 
 		auto chunk_id = -1;
 		while (chunk_stmt.executeStep()) chunk_id = chunk_stmt.getColumn(0).getInt();
@@ -624,7 +850,7 @@ void SQLiteStorage::save_chunk(const Chunk & chunk, const int32_t thread_num, co
 }
 
 constexpr std::string_view FetchNextEstimateQuery = R"~~~~~~(
-SELECT c.configuration_id, s.bootstrap_resamples, m.num_chunks, t.type_id
+SELECT c.configuration_id, s.bootstrap_resamples, m.num_chunks, t.type_id, s.error_estimator, s.bootstrap_tolerance
 FROM "simulations" s
 INNER JOIN "configurations" c ON c.simulation_id = s.simulation_id
 INNER JOIN "metadata" m ON c.metadata_id = m.metadata_id
@@ -657,6 +883,8 @@ std::optional<std::tuple<Estimate, std::vector<double_t>>> SQLiteStorage::next_e
 		const auto bootstrap_resamples = static_cast<std::size_t>(estimate_stmt.getColumn(1).getInt());
 		const auto num_chunks = estimate_stmt.getColumn(2).getInt();
 		const auto type = static_cast<observables::Type>(estimate_stmt.getColumn(3).getInt());
+		const auto error_estimator = static_cast<analysis::ErrorEstimator>(estimate_stmt.getColumn(4).getInt());
+		const auto bootstrap_tolerance = estimate_stmt.getColumn(5).getDouble();
 
 		SQLite::Statement worker { db, SetConfigurationActiveWorker.data() };
 		worker.bind("@configuration_id", configuration_id);
@@ -677,7 +905,7 @@ std::optional<std::tuple<Estimate, std::vector<double_t>>> SQLiteStorage::next_e
 		}
 		transaction.commit();
 
-		return { std::make_tuple<Estimate, std::vector<double_t>>({ configuration_id, type, bootstrap_resamples }, std::move(values)) };
+		return { std::make_tuple<Estimate, std::vector<double_t>>({ configuration_id, type, bootstrap_resamples, bootstrap_tolerance, error_estimator }, std::move(values)) };
 	} catch (std::exception & e) {
 		std::cout << "[SQLite] Failed to fetch next estimate. SQLite exception: " << e.what() << std::endl;
 		std::rethrow_exception(std::current_exception());
@@ -685,10 +913,10 @@ std::optional<std::tuple<Estimate, std::vector<double_t>>> SQLiteStorage::next_e
 }
 
 constexpr std::string_view InsertEstimateQuery = R"~~~~~~(
-INSERT INTO "estimates" (configuration_id, type_id, worker_id, thread_num, start_time, end_time, mean, std_dev) VALUES (@configuration_id, @type_id, @worker_id, @thread_num, @start_time, @end_time, @mean, @std_dev)
+INSERT INTO "estimates" (configuration_id, type_id, worker_id, thread_num, start_time, end_time, mean, std_dev, block_size, resamples) VALUES (@configuration_id, @type_id, @worker_id, @thread_num, @start_time, @end_time, @mean, @std_dev, @block_size, @resamples)
 )~~~~~~";
 
-void SQLiteStorage::save_estimate(const int configuration_id, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const observables::Type type, const double_t mean, const double_t std_dev) {
+void SQLiteStorage::save_estimate(const int configuration_id, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const observables::Type type, const double_t mean, const double_t std_dev, const std::optional<std::size_t> block_size, const std::optional<std::size_t> resamples) {
 	try {
 		SQLite::Transaction transaction { db, SQLite::TransactionBehavior::IMMEDIATE };
 
@@ -701,6 +929,8 @@ void SQLiteStorage::save_estimate(const int configuration_id, const int32_t thre
 		estimate_stmt.bind("@end_time", end_time);
 		estimate_stmt.bind("@mean", mean);
 		estimate_stmt.bind("@std_dev", std_dev);
+		if (block_size) estimate_stmt.bind("@block_size", static_cast<int>(*block_size)); else estimate_stmt.bind("@block_size");
+		if (resamples) estimate_stmt.bind("@resamples", static_cast<int>(*resamples)); else estimate_stmt.bind("@resamples");
 		estimate_stmt.exec();
 
 		SQLite::Statement worker_stmt { db, RemoveWorkerQuery.data() };
@@ -715,6 +945,110 @@ void SQLiteStorage::save_estimate(const int configuration_id, const int32_t thre
 	}
 }
 
+constexpr std::string_view FetchNextJointEstimateQuery = R"~~~~~~(
+SELECT c.configuration_id, c.temperature, s.bootstrap_resamples, m.num_chunks, s.error_estimator, s.bootstrap_tolerance
+FROM "simulations" s
+INNER JOIN "configurations" c ON c.simulation_id = s.simulation_id
+INNER JOIN "metadata" m ON c.metadata_id = m.metadata_id
+INNER JOIN "chunks" ch ON c.configuration_id = ch.configuration_id AND ch."index" = m.num_chunks
+WHERE s.simulation_id = @simulation_id AND c.completed_chunks = m.num_chunks AND (c.active_worker_id IS NULL OR c.active_worker_id IN (
+	SELECT "worker_id" FROM "workers" WHERE "last_active_at" < unixepoch('now', '-5 minutes')
+)) AND EXISTS (
+	SELECT 1 FROM "types" t
+	LEFT JOIN "estimates" e ON e.configuration_id = c.configuration_id AND e.type_id = t.type_id
+	WHERE e.type_id IS NULL AND (t.type_id BETWEEN 0 AND 7 OR (t.type_id = 8 AND m.algorithm = 1))
+)
+LIMIT 1
+)~~~~~~";
+
+constexpr std::string_view FetchAllConfigurationResults = R"~~~~~~(
+SELECT r.type_id, r.data
+FROM "chunks" c
+INNER JOIN "results" r ON c.chunk_id = r.chunk_id
+WHERE c.configuration_id = @configuration_id
+ORDER BY r.type_id, c."index"
+)~~~~~~";
+
+std::optional<std::tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>>> SQLiteStorage::next_joint_estimate(const int simulation_id) {
+	try {
+		SQLite::Transaction transaction { db, SQLite::TransactionBehavior::IMMEDIATE };
+
+		SQLite::Statement estimate_stmt { db, FetchNextJointEstimateQuery.data() };
+		estimate_stmt.bind("@simulation_id", simulation_id);
+		if (!estimate_stmt.executeStep()) return std::nullopt;
+
+		const auto configuration_id = estimate_stmt.getColumn(0).getInt();
+		const auto temperature = estimate_stmt.getColumn(1).getDouble();
+		const auto bootstrap_resamples = static_cast<std::size_t>(estimate_stmt.getColumn(2).getInt());
+		const auto num_chunks = estimate_stmt.getColumn(3).getInt();
+		const auto error_estimator = static_cast<analysis::ErrorEstimator>(estimate_stmt.getColumn(4).getInt());
+		const auto bootstrap_tolerance = estimate_stmt.getColumn(5).getDouble();
+
+		SQLite::Statement worker { db, SetConfigurationActiveWorker.data() };
+		worker.bind("@configuration_id", configuration_id);
+		worker.bind("@worker_id", worker_id);
+		if (worker.exec() != 1) return std::nullopt;
+
+		SQLite::Statement result_stmt { db, FetchAllConfigurationResults.data() };
+		result_stmt.bind("@configuration_id", configuration_id);
+
+		std::map<observables::Type, std::vector<double_t>> values {};
+		while (result_stmt.executeStep()) {
+			const auto type = static_cast<observables::Type>(result_stmt.getColumn(0).getInt());
+			const auto buffer = result_stmt.getColumn(1).getBlob();
+			const auto data = schemas::deserialize(buffer);
+
+			auto & series = values[type];
+			series.reserve(data.size() * num_chunks);
+			series.insert(series.end(), data.begin(), data.end());
+		}
+		transaction.commit();
+
+		return { std::make_tuple<JointEstimate, std::map<observables::Type, std::vector<double_t>>>({ configuration_id, temperature, bootstrap_resamples, bootstrap_tolerance, error_estimator }, std::move(values)) };
+	} catch (std::exception & e) {
+		std::cout << "[SQLite] Failed to fetch next joint estimate. SQLite exception: " << e.what() << std::endl;
+		std::rethrow_exception(std::current_exception());
+	}
+}
+
+constexpr std::string_view UpsertEstimateQuery = R"~~~~~~(
+INSERT INTO "estimates" (configuration_id, type_id, worker_id, thread_num, start_time, end_time, mean, std_dev, block_size, resamples) VALUES (@configuration_id, @type_id, @worker_id, @thread_num, @start_time, @end_time, @mean, @std_dev, @block_size, @resamples)
+ON CONFLICT DO UPDATE SET worker_id = excluded.worker_id, thread_num = excluded.thread_num, start_time = excluded.start_time, end_time = excluded.end_time, mean = excluded.mean, std_dev = excluded.std_dev, block_size = excluded.block_size, resamples = excluded.resamples
+)~~~~~~";
+
+void SQLiteStorage::save_estimates(const int configuration_id, const int32_t thread_num, const int64_t start_time, const int64_t end_time, const analysis::Estimates & estimates) {
+	try {
+		SQLite::Transaction transaction { db, SQLite::TransactionBehavior::IMMEDIATE };
+
+		SQLite::Statement estimate_stmt { db, UpsertEstimateQuery.data() };
+		for (const auto & [type, estimate] : estimates) {
+			const auto [mean, std_dev, block_size, resamples] = estimate;
+			estimate_stmt.bind("@configuration_id", configuration_id);
+			estimate_stmt.bind("@type_id", type);
+			estimate_stmt.bind("@worker_id", worker_id);
+			estimate_stmt.bind("@thread_num", thread_num);
+			estimate_stmt.bind("@start_time", start_time);
+			estimate_stmt.bind("@end_time", end_time);
+			estimate_stmt.bind("@mean", mean);
+			estimate_stmt.bind("@std_dev", std_dev);
+			if (block_size) estimate_stmt.bind("@block_size", static_cast<int>(*block_size)); else estimate_stmt.bind("@block_size");
+			if (resamples) estimate_stmt.bind("@resamples", static_cast<int>(*resamples)); else estimate_stmt.bind("@resamples");
+			estimate_stmt.exec();
+			estimate_stmt.reset();
+		}
+
+		SQLite::Statement worker_stmt { db, RemoveWorkerQuery.data() };
+		worker_stmt.bind("@configuration_id", configuration_id);
+		worker_stmt.bind("@worker_id", worker_id);
+		worker_stmt.exec();
+
+		transaction.commit();
+	} catch (const std::exception & e) {
+		std::cout << "[SQLite] Failed to save estimates. SQLite exception: " << e.what() << std::endl;
+		std::rethrow_exception(std::current_exception());
+	}
+}
+
 constexpr std::string_view FetchNextDerivativeQuery = R"~~~~~~(
 SELECT e.configuration_id, e.type_id, c.temperature, e.mean, e.std_dev, o.mean, o.std_dev
 FROM "estimates" e
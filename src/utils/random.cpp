@@ -0,0 +1,175 @@
+#include <algorithm>
+
+#include "utils/random.hpp"
+
+using state_type = utils::SimdXoshiro256Plus::state_type;
+
+/// Number of 64-bit streams held by a single register
+static constexpr std::size_t LANES = utils::SimdXoshiro256Plus::streams / utils::SimdXoshiro256Plus::registers;
+
+#if defined(__AVX512F__)
+static state_type load(const std::uint64_t * p) noexcept { return simde_mm512_loadu_si512(p); }
+static state_type add(const state_type a, const state_type b) noexcept { return simde_mm512_add_epi64(a, b); }
+static state_type bxor(const state_type a, const state_type b) noexcept { return simde_mm512_xor_si512(a, b); }
+static state_type shift_left(const state_type a) noexcept { return simde_mm512_slli_epi64(a, 17); }
+static state_type rotate_left(const state_type a) noexcept { return simde_mm512_rol_epi64(a, 45); }
+
+/**
+ * Sets the exponent of 1.0 on the upper 52 bits of each draw, which gives a double on [1, 2), and subtracts 1.0. This
+ * avoids a 64-bit integer to double conversion, but only yields multiples of 2^-52 rather than the multiples of 2^-53
+ * of XoshiroCpp::DoubleFromBits.
+ */
+static void store_doubles(double_t * out, const state_type v) noexcept {
+    const auto bits = simde_mm512_or_si512(simde_mm512_srli_epi64(v, 12), simde_mm512_set1_epi64(0x3FF0000000000000));
+    simde_mm512_storeu_pd(out, simde_mm512_sub_pd(simde_mm512_castsi512_pd(bits), simde_mm512_set1_pd(1.0)));
+}
+
+/// Multiplies the upper 32 bits of each draw with the range, which leaves the bounded integer in the upper half
+static void store_products(std::uint64_t * out, const state_type v, const std::uint32_t range) noexcept {
+    simde_mm512_storeu_si512(out, simde_mm512_mul_epu32(simde_mm512_srli_epi64(v, 32), simde_mm512_set1_epi64(range)));
+}
+
+/// Sets the exponent of 1.0f on the upper 23 bits of each draw and subtracts 1.0f, which gives multiples of 2^-23 on [0, 1)
+static void store_floats(float * out, const state_type v) noexcept {
+    const auto bits = simde_mm512_or_si512(simde_mm512_srli_epi64(v, 41), simde_mm512_set1_epi64(0x3F800000));
+    simde_mm256_storeu_ps(out, simde_mm256_sub_ps(simde_mm256_castsi256_ps(simde_mm512_cvtepi64_epi32(bits)), simde_mm256_set1_ps(1.0f)));
+}
+#else
+static state_type load(const std::uint64_t * p) noexcept { return simde_mm256_loadu_si256(reinterpret_cast<const simde__m256i *>(p)); }
+static state_type add(const state_type a, const state_type b) noexcept { return simde_mm256_add_epi64(a, b); }
+static state_type bxor(const state_type a, const state_type b) noexcept { return simde_mm256_xor_si256(a, b); }
+static state_type shift_left(const state_type a) noexcept { return simde_mm256_slli_epi64(a, 17); }
+static state_type rotate_left(const state_type a) noexcept { return simde_mm256_or_si256(simde_mm256_slli_epi64(a, 45), simde_mm256_srli_epi64(a, 19)); }
+
+/**
+ * Sets the exponent of 1.0 on the upper 52 bits of each draw, which gives a double on [1, 2), and subtracts 1.0. This
+ * avoids a 64-bit integer to double conversion, but only yields multiples of 2^-52 rather than the multiples of 2^-53
+ * of XoshiroCpp::DoubleFromBits.
+ */
+static void store_doubles(double_t * out, const state_type v) noexcept {
+    const auto bits = simde_mm256_or_si256(simde_mm256_srli_epi64(v, 12), simde_mm256_set1_epi64x(0x3FF0000000000000));
+    simde_mm256_storeu_pd(out, simde_mm256_sub_pd(simde_mm256_castsi256_pd(bits), simde_mm256_set1_pd(1.0)));
+}
+
+/// Multiplies the upper 32 bits of each draw with the range, which leaves the bounded integer in the upper half
+static void store_products(std::uint64_t * out, const state_type v, const std::uint32_t range) noexcept {
+    simde_mm256_storeu_si256(reinterpret_cast<simde__m256i *>(out), simde_mm256_mul_epu32(simde_mm256_srli_epi64(v, 32), simde_mm256_set1_epi64x(range)));
+}
+
+/// Sets the exponent of 1.0f on the upper 23 bits of each draw and subtracts 1.0f, which gives multiples of 2^-23 on [0, 1)
+static void store_floats(float * out, const state_type v) noexcept {
+    const auto bits = simde_mm256_or_si256(simde_mm256_srli_epi64(v, 41), simde_mm256_set1_epi64x(0x3F800000));
+    const auto narrowed = simde_mm256_castsi256_si128(simde_mm256_permutevar8x32_epi32(bits, simde_mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+    simde_mm_storeu_ps(out, simde_mm_sub_ps(simde_mm_castsi128_ps(narrowed), simde_mm_set1_ps(1.0f)));
+}
+#endif
+
+utils::XY_ISA::SimdXoshiro256Plus::SimdXoshiro256Plus(XoshiroCpp::Xoshiro256Plus & rng) noexcept {
+    // Transpose the scalar states of the streams into one array per state word
+    std::uint64_t states[4][streams];
+    for (std::size_t lane = 0; lane < streams; ++lane) {
+        const auto state = rng.serialize();
+        for (std::size_t word = 0; word < 4; ++word) {
+            states[word][lane] = state[word];
+        }
+        rng.jump();
+    }
+
+    for (std::size_t r = 0; r < registers; ++r) {
+        s0[r] = load(states[0] + r * LANES);
+        s1[r] = load(states[1] + r * LANES);
+        s2[r] = load(states[2] + r * LANES);
+        s3[r] = load(states[3] + r * LANES);
+    }
+}
+
+std::array<state_type, utils::SimdXoshiro256Plus::registers> utils::XY_ISA::SimdXoshiro256Plus::step() noexcept {
+    std::array<state_type, registers> result;
+    for (std::size_t r = 0; r < registers; ++r) {
+        result[r] = add(s0[r], s3[r]);
+
+        const auto t = shift_left(s1[r]);
+        s2[r] = bxor(s2[r], s0[r]);
+        s3[r] = bxor(s3[r], s1[r]);
+        s1[r] = bxor(s1[r], s2[r]);
+        s0[r] = bxor(s0[r], s3[r]);
+        s2[r] = bxor(s2[r], t);
+        s3[r] = rotate_left(s3[r]);
+    }
+    return result;
+}
+
+void utils::XY_ISA::SimdXoshiro256Plus::fill(const std::span<double_t> out) noexcept {
+    std::size_t i = 0;
+    for (; i + streams <= out.size(); i += streams) {
+        const auto values = step();
+        for (std::size_t r = 0; r < registers; ++r) {
+            store_doubles(out.data() + i + r * LANES, values[r]);
+        }
+    }
+
+    // Generate one more step for the tail and drop the surplus
+    if (i < out.size()) {
+        double_t tail[streams];
+        fill(tail);
+        std::copy_n(tail, out.size() - i, out.data() + i);
+    }
+}
+
+void utils::XY_ISA::SimdXoshiro256Plus::fill(const std::span<float> out) noexcept {
+    std::size_t i = 0;
+    for (; i + streams <= out.size(); i += streams) {
+        const auto values = step();
+        for (std::size_t r = 0; r < registers; ++r) {
+            store_floats(out.data() + i + r * LANES, values[r]);
+        }
+    }
+
+    // Generate one more step for the tail and drop the surplus
+    if (i < out.size()) {
+        float tail[streams];
+        fill(tail);
+        std::copy_n(tail, out.size() - i, out.data() + i);
+    }
+}
+
+void utils::XY_ISA::SimdXoshiro256Plus::bounded(const std::span<std::uint32_t> out, const std::uint32_t range) noexcept {
+    // The lower half of a product falls below 2^32 mod range for exactly the draws which have to be rejected
+    const auto threshold = static_cast<std::uint32_t>(-range) % range;
+
+    alignas(64) std::uint64_t products[streams];
+    for (std::size_t i = 0; i < out.size(); i += streams) {
+        const auto values = step();
+        for (std::size_t r = 0; r < registers; ++r) {
+            store_products(products + r * LANES, values[r], range);
+        }
+
+        for (std::size_t lane = 0; lane < streams && i + lane < out.size(); ++lane) {
+            auto product = products[lane];
+            while (static_cast<std::uint32_t>(product) < threshold) [[unlikely]] {
+                alignas(64) std::uint64_t redrawn[streams];
+                store_products(redrawn, step()[0], range);
+                product = redrawn[0];
+            }
+            out[i + lane] = static_cast<std::uint32_t>(product >> 32);
+        }
+    }
+}
+
+template<>
+std::span<const double_t> utils::XY_ISA::SimdXoshiro256Plus::uniforms(const std::size_t n) noexcept {
+    if (doubles.size() < n) {
+        doubles.resize(n);
+    }
+    fill(std::span { doubles.data(), n });
+    return { doubles.data(), n };
+}
+
+template<>
+std::span<const float> utils::XY_ISA::SimdXoshiro256Plus::uniforms(const std::size_t n) noexcept {
+    if (floats.size() < n) {
+        floats.resize(n);
+    }
+    fill(std::span { floats.data(), n });
+    return { floats.data(), n };
+}